@@ -1,6 +1,8 @@
 #pragma once
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "logger.hpp"
 
@@ -9,6 +11,14 @@ enum LogLevel;
 
 using std::string;
 
+// crun matrix: все сочетания вариантов аргументов и значений переменных окружения
+struct Matrix {
+    std::vector<string> args;                                        // дописываются к exeArgs
+    std::vector<std::pair<string, std::vector<string>>> env;         // переменная → значения
+    unsigned parallel = 1;  // ячеек одновременно, каждая на своём наборе CPU
+    string output;          // .csv или .json; пусто — <build>/<name>.matrix.csv
+};
+
 struct Args {
     bool clear = false;
     Launch launch = BOTH;
@@ -18,6 +28,48 @@ struct Args {
     std::set<string> files, folders, includeDirs, libDirs, libsList;
     string compiler, compilerOptions, exeArgs;
     LogLevel logLevel = FAULT;
+    bool smaps = false;    // читать полный smaps на пике памяти (heap/stack)
+    bool perf = false;     // счётчики perf_event_open
+    bool topDown = false;  // TMA уровня 1 через perf_event_open
+    bool profile = false;  // crun profile: сэмплирующий профилировщик и flame graph
+    bool heap = false;     // счётчик аллокаций через LD_PRELOAD
+    bool locks = false;    // ожидание блокировок pthread через LD_PRELOAD
+    unsigned syscalls = 0; // трассировка системных вызовов: доля времени в %, 0 — выключена
+    unsigned bench = 0;    // crun bench: число замеров, 0 — обычный запуск
+    unsigned warmup = 1;   // прогревочных запусков перед замерами
+    string compareWith;     // A/B: второй исполняемый файл или "baseline"
+    string compareOptions;  // A/B: вторая сборка с этими опциями вместо compilerOptions
+    bool compareBuild = false;
+    bool saveBaseline = false;  // сохранить собранный файл как baseline для -vs baseline
+    string cpus;             // -cpus 0,2-3: affinity программы
+    int nice = 0;            // nice программы; 0 — не менять
+    string ioPriority;       // -ioprio rt|be|idle[:уровень]
+    bool noAslr = false;     // отключить ASLR для одинаковой раскладки памяти
+    double timeout = 0;                   // -timeout: лимит wall-времени, с; 0 — без лимита
+    unsigned cpuLimit = 0;                // -cpu-limit: RLIMIT_CPU, с
+    unsigned long long memoryLimitMb = 0; // -mem-limit: RSS через memory.max cgroup (иначе и в load — RLIMIT_AS)
+    unsigned long long addressLimitMb = 0;// -as-limit: RLIMIT_AS
+    unsigned filesLimit = 0;              // -files-limit: RLIMIT_NOFILE
+    string stdinFile;           // -in: stdin программы из файла
+    string stderrFile;          // stderr программы в файл с показом после выхода (для кэша запусков)
+    string stdoutMode;          // -stdout discard|file|tail|tee; пусто — в терминал
+    string stdoutFile;          // файл для file и tee, пусто — <build>/<name>.stdout
+    unsigned stdoutTail = 20;   // строк для tail
+    unsigned load = 0;          // crun load: экземпляров одновременно, 0 — обычный запуск
+    bool scaleRun = false;      // crun scale: замеры с числом потоков от 1 до числа ядер
+    unsigned scaleMax = 0;      // верхняя граница потоков, 0 — число ядер
+    string threadsVar = "OMP_NUM_THREADS";  // как передать число потоков, если в аргументах нет {threads}
+    bool matrixRun = false;     // crun matrix
+    string judgeDir;            // crun judge: папка с тестами *.in / *.out
+    std::vector<string> stress;  // crun stress: генератор, эталон, решение
+    unsigned long long stressLimit = 0;  // итераций stress, 0 — до первого расхождения
+    string compare = "tokens";  // сравнение с ответом: exact | tokens | float
+    double epsilon = 1e-6;      // погрешность чисел для compare: float
+    string checker;             // чекер для judge и stress вместо compare: исходник или исполняемый файл
+    Matrix matrix;
+    bool cache = false;         // -cache: повторять сохранённый результат вместо запуска
+    std::set<string> cacheEnv;  // переменные окружения, входящие в ключ кэша
+    double failIfSlower = 0;    // ошибка, если медленнее истории больше чем на X%; 0 — не проверять
     string scriptToRun = "";
 };
 
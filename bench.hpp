@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+struct HistoryEntry;
+
+// crun bench: warmup прогревочных запусков, затем arguments.bench замеров и статистика по ним;
+// record — куда сложить итоги для истории запусков
+int runBenchmark(const std::string& cmd, HistoryEntry* record = nullptr);
+// A/B: запуски двух вариантов чередуются; ускорение A относительно B с доверительным интервалом
+// и U-критерием Манна–Уитни
+int runComparison(const std::string& cmdA, const std::string& labelA, const std::string& cmdB,
+                  const std::string& labelB);
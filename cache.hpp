@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+
+// Кэш результатов запуска (-cache) для детерминированных программ: ключ — хеш исполняемого
+// файла, exeArgs, переменных из arguments.cacheEnv, лимитов и настроек запуска (-mem-limit,
+// -as-limit, -cpu-limit, -files-limit, -timeout, -nice, -ioprio, -cpus, -no-aslr) и файла -in.
+// Без -in запуск не кэшируется: ввод из терминала или pipe в ключ не попадает.
+// Хранит код (в том числе ненулевой — он входит в результат), stdout и stderr в <build>/.cache/<ключ>/
+
+// Ключ для exe; пусто — этот запуск кэшировать нельзя
+std::string runCacheKey(const std::string& exe);
+// Печатает сохранённые stdout и stderr; false — в кэше ничего нет
+bool replayRun(const std::string& key, int& code);
+// Направляет вывод следующего runScript в запись кэша; без storeRunCache она не считается готовой
+void prepareRunCache(const std::string& key);
+// Сохраняет запись, если программа завершилась сама (code >= 0), иначе выбрасывает
+void storeRunCache(const std::string& key, int code);
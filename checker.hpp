@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct CheckResult {
+    std::string verdict;  // OK, WA, PE; CF — сам чекер упал или не запустился
+    double score = 0;
+    std::string comment;
+};
+
+// Запускает чекер как `checker <input> <expected> <actual>` с выводом в actual + ".check".
+// Код 0 — OK, 1 — WA, 2 — PE, другой — CF. Первая строка stdout: "[балл] [комментарий]",
+// без числа балл 1 для OK и 0 иначе. cpus — где запускать чекер (пусто — любые)
+CheckResult runChecker(const std::string& checker, const std::string& input, const std::string& expected,
+                       const std::string& actual, const std::vector<int>& cpus = {});
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+struct CompareResult {
+    bool same = false;
+    std::string difference;  // где и что разошлось, или почему сравнить не удалось
+};
+
+// Потоковое сравнение вывода программы с ответом по arguments.compare:
+// exact — побайтно, tokens — с точностью до пробельных символов,
+// float — как tokens, но числа равны с погрешностью arguments.epsilon (абсолютной или относительной)
+CompareResult compareFiles(const std::string& expected, const std::string& actual);
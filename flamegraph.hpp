@@ -0,0 +1,10 @@
+#pragma once
+#include <map>
+#include <string>
+
+// Свёрнутые стеки: "comm;main;foo;bar" → число сэмплов
+using FoldedStacks = std::map<std::string, unsigned long long>;
+
+bool writeFolded(const FoldedStacks& stacks, const std::string& path);
+// Самодостаточный SVG без внешних скриптов и шрифтов
+bool writeFlameGraph(const FoldedStacks& stacks, const std::string& path, const std::string& title);
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Одна запись истории запусков (.crun/history.jsonl, по строке JSON на запуск)
+struct HistoryEntry {
+    long long time = 0;   // unix-время, с
+    std::string commit;   // git describe --always --dirty; пусто вне репозитория
+    std::string name;     // имя программы
+    std::string kind;     // "run" — запуск с монитором, "bench" — серия замеров
+    std::string options;  // опции компилятора
+    std::string args;     // аргументы программы
+    std::string setup;    // инструменты и условия запуска ("-syscalls 100 -cpus 0"); пусто — обычный запуск
+    unsigned runs = 1;
+    int code = 0;
+    double wallMs = 0;        // для bench — медиана
+    double wallStddevMs = 0;  // для bench — σ, иначе 0
+    double userMs = 0, systemMs = 0;
+    unsigned long long maxRssKb = 0;
+    unsigned long long instructions = 0, cycles = 0;  // 0 — не измерялись
+};
+
+// Флаги из arguments, меняющие время запуска: инструменты (-syscalls, -heap, -perf...), -stdout, -in,
+// affinity и лимиты; записи с разными флагами между собой не сравниваются
+std::string runSetup();
+// Дописывает запись (время и коммит заполняются здесь); false — не удалось записать
+bool appendHistory(HistoryEntry& entry);
+std::vector<HistoryEntry> readHistory();
+// Сравнивает wall с медианой последних успешных запусков с теми же опциями, аргументами и setup;
+// true — медленнее больше чем на percent%
+bool slowerThanHistory(const HistoryEntry& entry, double percent);
+// crun history [name] [-n N]
+int showHistory(int argc, char* argv[]);
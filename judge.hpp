@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+// crun judge dir/: прогоняет cmd на каждом dir/*.in параллельно на всех CPU с лимитами
+// -timeout и -mem-limit, сравнивает вывод с *.out (или *.ans) и печатает вердикты.
+// ML — OOM в cgroup с memory.max; если cgroup недоступна и -mem-limit стал RLIMIT_AS,
+// ML ставится по падению программы (SIGABRT, SIGSEGV, SIGBUS) под этим лимитом.
+// checker — команда чекера вместо встроенного сравнения; пусто — arguments.compare
+int runJudge(const std::string& cmd, const std::string& checker = "");
@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// crun load: arguments.load экземпляров cmd одновременно; "{i}" в cmd заменяется номером экземпляра,
+// он же передаётся в CRUN_INSTANCE. Отчёт — пропускная способность, распределение задержек, CPU и RSS
+int runLoad(const std::string& cmd);
@@ -11,4 +11,6 @@ void logMessage(const LogLevel& level, const std::string& msg, bool always = fal
 
 void logMessage(const LogLevel& level, const std::string& msg, bool always, const std::string& prefix);
 
-void logMessageA(const LogLevel& level, const std::string& msg, bool always = false);
\ No newline at end of file
+void logMessageA(const LogLevel& level, const std::string& msg, bool always = false);
+// Число с двумя знаками после запятой для отчётов: "12.35"
+std::string fixed2(double value);
@@ -1,10 +1,13 @@
 #include <windows.h>
 
+#include <cctype>
+#include <cstdlib>
 #include <filesystem>
 #include <stdexcept>
 
 #include "args.hpp"
 #include "config.hpp"
+#include "history.hpp"
 #include "logger.hpp"
 #include "runner.hpp"
 
@@ -34,6 +37,9 @@ fs::path getExecutablePath() {
 
 int main(int argc, char* argv[]) {
     std::string script;
+    // число из crun bench N применяется после конфига, как -bench N в parseArgs: ключ bench его не заменит
+    bool benchCommand = false;
+    unsigned benchRuns = 0;
 
     setupConsoleUTF8();
 
@@ -46,6 +52,93 @@ int main(int argc, char* argv[]) {
             }
             script = argv[2];
         }
+        else if (command == "p" || command == "profile") {
+            arguments.profile = true;
+            --argc;
+            ++argv;
+        }
+        else if (command == "bench") {
+            // crun bench [N] <...>
+            benchCommand = true;
+            --argc;
+            ++argv;
+            if (argc >= 2 && isdigit(static_cast<unsigned char>(argv[1][0]))) {
+                benchRuns = static_cast<unsigned>(atoi(argv[1]));
+                --argc;
+                ++argv;
+            }
+        }
+        else if (command == "load") {
+            // crun load [-n] K <...>
+            arguments.load = 4;
+            --argc;
+            ++argv;
+            if (argc >= 3 && std::string(argv[1]) == "-n") {
+                --argc;
+                ++argv;
+            }
+            if (argc >= 2 && isdigit(static_cast<unsigned char>(argv[1][0]))) {
+                arguments.load = static_cast<unsigned>(atoi(argv[1]));
+                --argc;
+                ++argv;
+            }
+        }
+        else if (command == "scale") {
+            // crun scale [N] <...>
+            arguments.scaleRun = true;
+            --argc;
+            ++argv;
+            if (argc >= 2 && isdigit(static_cast<unsigned char>(argv[1][0]))) {
+                arguments.scaleMax = static_cast<unsigned>(atoi(argv[1]));
+                --argc;
+                ++argv;
+            }
+        }
+        else if (command == "matrix") {
+            // crun matrix <...>: сочетания из matrix в конфиге
+            arguments.matrixRun = true;
+            --argc;
+            ++argv;
+        }
+        else if (command == "judge") {
+            // crun judge <dir> <...>
+            --argc;
+            ++argv;
+            if (argc < 2 || !fs::is_directory(argv[1])) {
+                logMessage(FAULT, "Укажите папку с тестами: crun judge <dir> <...>");
+                return 1;
+            }
+            arguments.judgeDir = argv[1];
+            --argc;
+            ++argv;
+        }
+        else if (command == "stress") {
+            // crun stress [N] gen.cpp brute.cpp sol.cpp <...>
+            --argc;
+            ++argv;
+            if (argc >= 2 && isdigit(static_cast<unsigned char>(argv[1][0]))) {
+                arguments.stressLimit = strtoull(argv[1], nullptr, 10);
+                --argc;
+                ++argv;
+            }
+            if (argc < 4) {
+                logMessage(FAULT, "Укажите три файла: crun stress gen.cpp brute.cpp sol.cpp <...>");
+                return 1;
+            }
+            for (int i = 1; i <= 3; ++i) {
+                if (!fs::is_regular_file(argv[i])) {
+                    logMessage(FAULT, std::string("Не найден: ") + argv[i]);
+                    return 1;
+                }
+                arguments.stress.push_back(argv[i]);
+            }
+            argc -= 3;
+            argv += 3;
+        }
+        else if (command == "history") {
+            // crun history [name] [-n N]
+            return showHistory(argc - 2, argv + 2);
+        }
         else if (command == "v" || command == "version") {
             logMessage(INFO, std::string("CRUN ") + VERSION, true, "🧠");
             return 0;
@@ -55,6 +148,14 @@ int main(int argc, char* argv[]) {
 
             logMessage(INFO, "Команды:", true, "📌");
             logMessageA(INFO, "    run <script>         — выполнить из crun.yaml", true);
+            logMessageA(INFO, "    profile <...>        — сборка с frame pointer, профиль и flame graph", true);
+            logMessageA(INFO, "    bench [N] <...>      — N замеров (по умолчанию 10) и статистика времени и памяти", true);
+            logMessageA(INFO, "    load -n K <...>      — K экземпляров разом: пропускная способность, задержки, CPU, RAM", true);
+            logMessageA(INFO, "    scale [N] <...>      — потоки 1..N (по умолчанию число ядер): ускорение, эффективность", true);
+            logMessageA(INFO, "    matrix <...>         — все сочетания matrix.args × matrix.env из конфига, CSV/JSON", true);
+            logMessageA(INFO, "    judge <dir> <...>    — тесты dir/*.in с ответами *.out|*.ans параллельно, вердикты", true);
+            logMessageA(INFO, "    stress [N] gen brute sol — gen <seed> → сравнение brute и sol до расхождения", true);
+            logMessageA(INFO, "    history [name] [-n N] — история замеров из .crun/history.jsonl и тренды", true);
             logMessageA(INFO, "    init                 — создать шаблон crun.yaml", true);
             logMessageA(INFO, "    version              — показать версию", true);
             logMessageA(INFO, "    help                 — показать эту справку", true);
@@ -72,6 +173,39 @@ int main(int argc, char* argv[]) {
             logMessageA(INFO, "    -l <dir>          — добавить папку с библиотеками", true);
             logMessageA(INFO, "    -l <lib>          — добавить библиотеку", true);
             logMessageA(INFO, "    -o <options...>   — дополнительные опции компилятора", true);
+            logMessageA(INFO, "    -perf             — аппаратные счётчики (IPC, промахи кэша и ветвлений)", true);
+            logMessageA(INFO, "    -topdown          — top-down анализ: frontend/backend/bad speculation/retiring", true);
+            logMessageA(INFO, "    -smaps            — heap/stack из полного smaps на пике памяти", true);
+            logMessageA(INFO, "    -heap             — профиль аллокаций (malloc/new) через LD_PRELOAD", true);
+            logMessageA(INFO, "    -locks            — конкуренция за mutex/rwlock: ожидание по объектам и местам", true);
+            logMessageA(INFO, "    -syscalls [N]     — таблица системных вызовов (ptrace, медленно); N — % времени", true);
+            logMessageA(INFO, "    -bench N          — то же, что bench N", true);
+            logMessageA(INFO, "    -load K           — то же, что load -n K; {i} в аргументах — номер экземпляра", true);
+            logMessageA(INFO, "    -warmup W         — прогревочных запусков перед замерами (по умолчанию 1)", true);
+            logMessageA(INFO, "    -timeout S        — убить программу через S секунд wall-времени", true);
+            logMessageA(INFO, "    -cpu-limit S      — лимит CPU-времени (RLIMIT_CPU)", true);
+            logMessageA(INFO, "    -mem-limit MB     — лимит памяти (memory.max cgroup, иначе и в load — адресное пространство)", true);
+            logMessageA(INFO, "    -as-limit MB      — лимит адресного пространства (RLIMIT_AS)", true);
+            logMessageA(INFO, "    -files-limit N    — лимит открытых файлов (RLIMIT_NOFILE)", true);
+            logMessageA(INFO, "    -in FILE          — stdin программы из файла", true);
+            logMessageA(INFO, "    -cache            — повторить сохранённый результат, если бинарник, вход -in и лимиты те же (только с -in)", true);
+            logMessageA(INFO, "    -cache-env VAR    — переменная окружения, входящая в ключ кэша", true);
+            logMessageA(INFO, "    -compare MODE     — сравнение в judge: exact | tokens (по умолчанию) | float", true);
+            logMessageA(INFO, "    -checker FILE     — свой чекер: FILE <input> <expected> <actual>, код 0 — OK", true);
+            logMessageA(INFO, "    -eps X            — погрешность чисел для float (по умолчанию 1e-6)", true);
+            logMessageA(INFO, "    -stdout MODE      — вывод программы: discard | file | tail | tee", true);
+            logMessageA(INFO, "    -stdout-file PATH — файл для file и tee (по умолчанию <build>/<name>.stdout)", true);
+            logMessageA(INFO, "    -tail N           — показать только последние N строк вывода", true);
+            logMessageA(INFO, "    -cpus 0,2-3       — запускать программу только на этих CPU", true);
+            logMessageA(INFO, "    -nice N           — nice программы (-20..19)", true);
+            logMessageA(INFO, "    -ioprio be:4      — приоритет ввода-вывода: rt|be|idle[:0-7]", true);
+            logMessageA(INFO, "    -no-aslr          — отключить ASLR: одинаковые адреса от запуска к запуску", true);
+            logMessageA(INFO, "    -threads-var VAR  — переменная с числом потоков для scale (или {threads} в --)", true);
+            logMessageA(INFO, "    -j P              — ячеек матрицы одновременно, на разных CPU", true);
+            logMessageA(INFO, "    -vs <exe|baseline> — A/B-сравнение с другим файлом или сохранённым baseline", true);
+            logMessageA(INFO, "    -vso <options...> \\ — A/B-сравнение со сборкой с другими опциями", true);
+            logMessageA(INFO, "    -save-baseline    — сохранить собранный файл как baseline", true);
+            logMessageA(INFO, "    -fail-if-slower X — код 1, если медленнее медианы последних запусков на X%", true);
             logMessageA(INFO, "    -- <...>          — аргументы для исполняемого файла", true);
             return 0;
         }
@@ -88,11 +222,12 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // без N — bench из конфига, если он там есть, иначе 10
+    if (benchCommand) arguments.bench = benchRuns ? benchRuns : arguments.bench ? arguments.bench : 10;
+
     if (!arguments.scriptToRun.empty()) { return runScript(arguments.scriptToRun); }
 
     parseArgs(argc - 1, argv + 1);
 
-    run();
-
-    return 0;
+    return run();
 }
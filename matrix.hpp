@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// crun matrix: запускает cmd для всех сочетаний arguments.matrix, печатает таблицу
+// и сохраняет её в CSV или JSON
+int runMatrix(const std::string& cmd);
@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+#include <vector>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -15,13 +17,99 @@ using ProcessId = DWORD;
 using ProcessId = pid_t;
 #endif
 
+struct ThreadStats {
+    int tid = 0;
+    int pid = 0;
+    std::string name;             // comm потока
+    unsigned long long cpuMs = 0; // user + system
+
+    // /proc/<pid>/task/<tid>/schedstat и sched, нс
+    unsigned long long runNs = 0;       // на CPU
+    unsigned long long waitNs = 0;      // готов, но ждал в очереди планировщика
+    unsigned long long aliveNs = 0;     // от старта потока до последнего замера
+    unsigned long long blockNs = 0;     // в D-состоянии (только при kernel.sched_schedstats=1)
+    unsigned long long timeslices = 0;  // сколько раз получал CPU
+    unsigned long long migrations = 0, voluntarySwitches = 0, involuntarySwitches = 0;
+    bool sched = false;
+};
+
+// Куда ушло время потоков дерева, суммарно по всем потокам
+struct SchedStats {
+    unsigned long long runMs = 0;      // на CPU
+    unsigned long long waitMs = 0;     // в очереди планировщика (готов, но CPU занят)
+    unsigned long long offCpuMs = 0;   // спал или был заблокирован
+    unsigned long long blockMs = 0;    // из offCpuMs — D-состояние (обычно диск)
+    unsigned long long timeslices = 0;
+    unsigned long long migrations = 0, voluntarySwitches = 0, involuntarySwitches = 0;
+    bool valid = false;
+    bool blockKnown = false;  // blockMs доступен (schedstats включены)
+};
+
+// Разбивка памяти дерева процессов в момент пика RSS, в KB
+struct MemoryBreakdown {
+    unsigned long long rss = 0;
+    unsigned long long pss = 0;   // общие страницы поделены между процессами
+    unsigned long long uss = 0;   // Private_Clean + Private_Dirty
+    unsigned long long anon = 0;  // анонимная память
+    unsigned long long file = 0;  // файловые отображения (Rss - Anonymous)
+    unsigned long long swap = 0;
+    unsigned long long heap = 0;   // [heap], только с полным smaps
+    unsigned long long stack = 0;  // [stack], только с полным smaps
+    bool valid = false;
+    bool detailed = false;  // heap/stack прочитаны из полного smaps
+};
+
 struct MonitoringResult {
     unsigned cpuAverage = 0;  // среднее использование CPU
     unsigned cpuMax = 0;      // максимум CPU
     unsigned ramAverage = 0;  // среднее использование RAM
     unsigned ramMax = 0;      // максимум RAM
+
+    unsigned long long cpuUserMs = 0;    // user-время всего дерева процессов
+    unsigned long long cpuSystemMs = 0;  // system-время всего дерева процессов
+    unsigned processesMax = 0;           // максимум процессов в дереве
+
+    unsigned long long ioReadBytes = 0;   // чтение с диска (io.stat или read_bytes)
+    unsigned long long ioWriteBytes = 0;  // запись на диск (io.stat или write_bytes)
+    unsigned long long ioReadChars = 0;   // rchar: всё прочитанное, включая кэш и pipe
+    unsigned long long ioWriteChars = 0;  // wchar
+    unsigned long long ioReadCalls = 0;   // syscr
+    unsigned long long ioWriteCalls = 0;  // syscw
+    double ioReadPeakMBs = 0;             // пиковая скорость чтения (rchar), MB/s
+    double ioWritePeakMBs = 0;            // пиковая скорость записи (wchar), MB/s
+    unsigned long long ioCallsPeak = 0;   // пик syscr + syscw в секунду
+    bool io = false;                      // /proc/<pid>/io был доступен
+
+    bool cgroup = false;  // данные получены из cgroup v2, а не обходом /proc
+
+    unsigned threadsMax = 0;               // максимум потоков одновременно
+    unsigned threadsAverage = 0;           // среднее число потоков
+    std::vector<unsigned> threadTimeline;  // число потоков на каждом замере
+    std::vector<ThreadStats> threads;      // все замеченные потоки, по убыванию CPU
+
+    SchedStats sched;            // schedstat/sched всех потоков
+
+    MemoryBreakdown peakMemory;  // снимок smaps_rollup на пике RSS
 };
 
-void collectProcessStats(ProcessId pid, MonitoringResult& result);
+// Запускает фоновый сбор статистики; cgroup — папка cgroup v2 запуска (может быть пустой)
+void monitorProcess(ProcessId pid, MonitoringResult& result, const std::string& cgroup = "");
+// Снимает последний замер и останавливает сбор
 void shutdownMonitor();
-void monitorProcess(ProcessId pid, MonitoringResult& result);
+
+#ifndef _WIN32
+// Временная cgroup v2 для одного запуска; пустая строка, если создать не удалось
+std::string createRunCgroup();
+bool attachToCgroup(const std::string& cgroup, pid_t pid);
+// Возвращает pid в родительскую cgroup (ту, где работает crun), чтобы cgroup можно было удалить
+void detachFromCgroup(const std::string& cgroup, pid_t pid);
+void removeRunCgroup(const std::string& cgroup);
+// Лимит памяти cgroup (memory.max, без swap); false — контроллер memory недоступен
+bool limitRunCgroup(const std::string& cgroup, unsigned long long bytes);
+// Сколько раз в cgroup срабатывал OOM killer
+unsigned long long cgroupOomKills(const std::string& cgroup);
+// Убивает все процессы cgroup (cgroup.kill или SIGKILL каждому)
+void killRunCgroup(const std::string& cgroup);
+// Освобождает завершившийся процесс и дополняет result точными итогами (rusage, ввод-вывод); возвращает статус
+int reapProcess(pid_t pid, MonitoringResult* result);
+#endif
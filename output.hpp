@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdio>
+#include <string>
+
+// Что стало со stdout программы в режиме -stdout
+struct OutputStats {
+    unsigned long long bytes = 0;
+    unsigned long long lines = 0;
+    std::string tail;  // последние строки для tail
+    std::string file;  // куда записан вывод для file и tee
+};
+
+// Печатает файл целиком в stream (stdout или stderr), например сохранённый вывод
+void printFile(const std::string& path, FILE* stream);
+
+#ifndef _WIN32
+// Готовит приём stdout по arguments.stdoutMode: pipe с большим буфером и файл.
+// Возвращает fd для stdout программы, -1 — вывод идёт как обычно
+int openOutputCapture();
+// После запуска программы: закрывает у себя её конец pipe и принимает вывод в фоне
+void startOutputCapture();
+// Дожидается, пока все писатели закроют pipe, и подводит итоги
+void finishOutputCapture(OutputStats& stats);
+#endif
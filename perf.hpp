@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+struct PerfCounter {
+    unsigned long long value = 0;  // с поправкой на мультиплексирование
+    double running = 0;            // доля времени, когда счётчик реально считал (0..1)
+    bool ok = false;
+};
+
+// Top-down (TMA) уровня 1: доли слотов конвейера, сумма = 1
+struct TopDown {
+    double frontendBound = 0;
+    double badSpeculation = 0;
+    double backendBound = 0;
+    double retiring = 0;
+    double running = 0;  // минимальная доля времени работы групп (мультиплексирование)
+    bool ok = false;
+};
+
+struct PerfResult {
+    PerfCounter cycles;
+    PerfCounter instructions;
+    PerfCounter cacheReferences;
+    PerfCounter cacheMisses;
+    PerfCounter branches;
+    PerfCounter branchMisses;
+    PerfCounter taskClock;  // нс
+    PerfCounter pageFaults;
+
+    bool hardware = false;  // аппаратные счётчики доступны
+    bool software = false;
+    bool userOnly = false;  // perf_event_paranoid разрешил считать только user-space
+
+    TopDown topDown;
+};
+
+#ifndef _WIN32
+// Открывает счётчики на ещё не выполнившем exec процессе (enable_on_exec, inherit);
+// general — общие счётчики (-perf), topDown — группы для TMA уровня 1 (-topdown)
+bool openPerfCounters(pid_t pid, bool general, bool topDown);
+// Читает итоговые значения и закрывает счётчики
+void readPerfCounters(PerfResult& result);
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct HeapSite {
+    unsigned long long calls = 0;  // оценка: мелкие сэмплы × шаг сэмплирования, крупные — точно
+    unsigned long long bytes = 0;
+    std::string stack;  // "func <- caller <- ..."
+};
+
+struct HeapResult {
+    unsigned long long mallocCalls = 0;  // malloc, calloc, memalign и т.п.
+    unsigned long long reallocCalls = 0;
+    unsigned long long freeCalls = 0;
+    unsigned long long newCalls = 0;
+    unsigned long long deleteCalls = 0;
+    unsigned long long bytes = 0;   // всего запрошено
+    unsigned long long peak = 0;    // пик живой кучи одного процесса
+    unsigned long long leaked = 0;  // живая куча на выходе
+    unsigned rate = 0;              // каждая rate-я мелкая аллокация с backtrace
+    unsigned processes = 0;
+    std::vector<HeapSite> sites;    // по убыванию байт
+    bool ok = false;
+};
+
+struct LockStat {
+    std::string kind;  // mutex, rwlock-r, rwlock-w
+    std::string name;  // символ глобального объекта или адрес
+    unsigned long long acquisitions = 0, contended = 0, waitNs = 0, maxWaitNs = 0;
+};
+
+struct LockSite {
+    std::string kind;
+    std::string stack;
+    unsigned long long contended = 0, waitNs = 0;
+};
+
+struct LockResult {
+    unsigned long long acquisitions = 0, contended = 0, waitNs = 0;
+    unsigned long long condWaits = 0, condWaitNs = 0;  // pthread_cond_wait — простой, а не конкуренция
+    unsigned processes = 0;
+    std::vector<LockStat> locks;  // по убыванию времени ожидания
+    std::vector<LockSite> sites;
+    bool ok = false;
+};
+
+#ifndef _WIN32
+// Собирает интерпозер в папке сборки (если изменился) и добавляет его в LD_PRELOAD окружения запуска
+bool prepareHeapProfiler(std::vector<std::string>& env);
+// Сводит отчёты всех процессов дерева и удаляет их файлы
+void collectHeapReport(HeapResult& result);
+// То же для блокировок pthread: mutex, rwlock и ожидание условий
+bool prepareLockProfiler(std::vector<std::string>& env);
+void collectLockReport(LockResult& result);
+#endif
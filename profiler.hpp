@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+
+#ifndef _WIN32
+#include <sys/types.h>
+
+// Начинает профилирование процесса, ждущего exec: perf_event (callchain по frame pointer),
+// если недоступен — сэмплирование стеков через ptrace; false — ни то ни другое
+bool startProfiler(pid_t pid);
+// Ждёт завершения pid, не освобождая зомби; в режиме ptrace заодно снимает стеки
+void waitProfiled(pid_t pid);
+// Останавливает сбор, пишет <name>.folded и <name>.svg в папку сборки и печатает горячие функции
+void finishProfiler();
+// Имя функции или глобального объекта по модулю и смещению от его базового адреса (как у dladdr)
+std::string symbolizeModuleOffset(const std::string& module, unsigned long long offset);
+#endif
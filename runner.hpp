@@ -1,5 +1,57 @@
 #pragma once
 #include <string>
+#include <vector>
 
-int runScript(const std::string& script, bool monitoring = false);
-void run();
+struct HistoryEntry;
+
+// Итог одного запуска без монитора — для повторных замеров
+struct RunStats {
+    int code = -1;
+    double wallMs = 0;
+    double userMs = 0;
+    double systemMs = 0;
+    unsigned long long maxRssKb = 0;  // пиковый RSS процесса (и дождавшихся им потомков)
+    bool ok = false;                  // процесс удалось запустить
+    std::string stopReason;           // почему программа остановлена не сама (лимит, сигнал); пусто — вышла сама
+    bool timedOut = false;            // убита по -timeout
+    bool memoryExceeded = false;      // превышен -mem-limit: OOM в cgroup или, без неё, падение под RLIMIT_AS
+};
+
+// Задаёт KEY=value в окружении запуска; append — разделитель, если значение нужно дописать к старому
+void setEnvVar(std::vector<std::string>& env, const std::string& key, const std::string& value, char append = 0);
+// record — куда сложить итоги мониторинга для истории запусков
+int runScript(const std::string& script, bool monitoring = false, HistoryEntry* record = nullptr);
+// Тот же запуск без монитора и отчёта; quiet — вывод программы в /dev/null;
+// env — KEY=value поверх окружения crun, cpus — номера CPU, на которых запускать (пусто — любые);
+// input и output — файлы для stdin (вместо -in) и stdout; controls — применять лимиты, -timeout,
+// -in и настройки запуска из arguments (false — для вспомогательных программ вроде чекера)
+RunStats runOnce(const std::string& cmd, bool quiet, const std::vector<std::string>& env = {},
+                 const std::vector<int>& cpus = {}, const std::string& input = "", const std::string& output = "",
+                 bool controls = true);
+// Сборка и запуск по arguments; код завершения crun
+int run();
+
+#ifndef _WIN32
+#include <sched.h>
+#include <sys/types.h>
+
+// Что сделать в дочернем процессе перед exec (только async-signal-safe действия)
+struct ChildSetup {
+    int stdinFd = -1;   // -1 — унаследовать
+    int stdoutFd = -1;
+    int stderrFd = -1;
+    bool pinned = false;  // sched_setaffinity(cpus) перед exec
+    cpu_set_t cpus{};
+    int nice = 0;         // setpriority; 0 — не менять
+    int ioPriority = -1;  // ioprio_set, IOPRIO_PRIO_VALUE(класс, уровень); -1 — не менять
+    bool noAslr = false;  // personality(ADDR_NO_RANDOMIZE)
+    // setrlimit перед exec; 0 — без лимита
+    unsigned long long cpuSeconds = 0, addressSpace = 0, openFiles = 0;
+};
+
+// fork + exec команды (простая — напрямую, иначе через /bin/sh -c); ребёнок стоит до закрытия gate,
+// чтобы родитель успел подготовить cgroup, счётчики и т.п.; -1 при ошибке
+pid_t spawnGated(const std::string& cmd, const std::vector<std::string>& env, const ChildSetup& setup, int& gate);
+// Открывает -in для stdin очередного запуска: у каждого своё смещение в файле. -1 — -in не задан или ошибка
+int openRunInput();
+#endif
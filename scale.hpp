@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+
+// crun scale: замеры cmd с числом потоков от 1 до числа ядер; число потоков передаётся
+// через {threads} в cmd или переменную окружения arguments.threadsVar. Ускорение,
+// эффективность и метрика Карпа–Флатта — таблицей и в CSV
+int runScaling(const std::string& cmd);
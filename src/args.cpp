@@ -1,5 +1,8 @@
 #include "../args.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <filesystem>
 
 #include "../logger.hpp"
@@ -46,6 +49,80 @@ void parseArgs(int argc, char* argv[]) {
                 else arguments.libsList.insert(next);
             }
         }
+        else if (arg == "-smaps") arguments.smaps = true;
+        else if (arg == "-perf") arguments.perf = true;
+        else if (arg == "-topdown") arguments.topDown = true;
+        else if (arg == "-heap") arguments.heap = true;
+        else if (arg == "-locks") arguments.locks = true;
+        else if (arg == "-syscalls") {
+            // необязательный процент времени под трассировкой: -syscalls 10
+            arguments.syscalls = 100;
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                int value = atoi(argv[++i]);
+                arguments.syscalls = value < 1 ? 1 : value > 100 ? 100 : value;
+            }
+        }
+        else if (arg == "-bench" || arg == "-warmup" || arg == "-load") {
+            unsigned& value = arg == "-bench" ? arguments.bench : arg == "-warmup" ? arguments.warmup : arguments.load;
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) value = atoi(argv[++i]);
+            else logMessage(WARN, "После " + arg + " нужно число");
+        }
+        else if (arg == "-vs") setNextArg(i, arguments.compareWith);
+        else if (arg == "-vso") {
+            readUntilBackslash(i, arguments.compareOptions);
+            arguments.compareBuild = true;
+        }
+        else if (arg == "-j") {
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                arguments.matrix.parallel = std::max(1, atoi(argv[++i]));
+            else logMessage(WARN, "После -j нужно число");
+        }
+        else if (arg == "-timeout") {
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) arguments.timeout = atof(argv[++i]);
+            else logMessage(WARN, "После -timeout нужно число секунд");
+        }
+        else if (arg == "-cpu-limit" || arg == "-files-limit") {
+            unsigned& value = arg == "-cpu-limit" ? arguments.cpuLimit : arguments.filesLimit;
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) value = atoi(argv[++i]);
+            else logMessage(WARN, "После " + arg + " нужно число");
+        }
+        else if (arg == "-mem-limit" || arg == "-as-limit") {
+            unsigned long long& value = arg == "-mem-limit" ? arguments.memoryLimitMb : arguments.addressLimitMb;
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) value = strtoull(argv[++i], nullptr, 10);
+            else logMessage(WARN, "После " + arg + " нужно число MB");
+        }
+        else if (arg == "-in") setNextArg(i, arguments.stdinFile);
+        else if (arg == "-cache") arguments.cache = true;
+        else if (arg == "-cache-env") pushNextArg(i, arguments.cacheEnv);
+        else if (arg == "-compare") setNextArg(i, arguments.compare);
+        else if (arg == "-checker") setNextArg(i, arguments.checker);
+        else if (arg == "-eps") {
+            if (i + 1 < argc) arguments.epsilon = atof(argv[++i]);
+            if (arguments.compare == "tokens") arguments.compare = "float";
+        }
+        else if (arg == "-stdout") setNextArg(i, arguments.stdoutMode);
+        else if (arg == "-stdout-file") {
+            setNextArg(i, arguments.stdoutFile);
+            if (arguments.stdoutMode.empty()) arguments.stdoutMode = "file";
+        }
+        else if (arg == "-tail") {
+            arguments.stdoutMode = "tail";
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                arguments.stdoutTail = std::max(1, atoi(argv[++i]));
+        }
+        else if (arg == "-cpus") setNextArg(i, arguments.cpus);
+        else if (arg == "-threads-var") setNextArg(i, arguments.threadsVar);
+        else if (arg == "-nice") {
+            if (i + 1 < argc) arguments.nice = std::max(-20, std::min(19, atoi(argv[++i])));
+        }
+        else if (arg == "-ioprio") setNextArg(i, arguments.ioPriority);
+        else if (arg == "-no-aslr") arguments.noAslr = true;
+        else if (arg == "-save-baseline") arguments.saveBaseline = true;
+        else if (arg == "-fail-if-slower" || arg == "--fail-if-slower") {
+            // -fail-if-slower 5 или 5%
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) arguments.failIfSlower = atof(argv[++i]);
+            else logMessage(WARN, "После " + arg + " нужен процент");
+        }
         else if (arg == "-info") arguments.logLevel = INFO;
         else if (arg == "-warn") arguments.logLevel = WARN;
         else if (arg == "-error") arguments.logLevel = FAULT;
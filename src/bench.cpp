@@ -0,0 +1,164 @@
+#include "../bench.hpp"
+
+#include <cstdio>
+#include <vector>
+
+#include "../args.hpp"
+#include "../history.hpp"
+#include "../logger.hpp"
+#include "../runner.hpp"
+#include "../stats.hpp"
+
+using std::string;
+
+// private
+static string pad(const string& text, size_t width) {
+    // ширина в символах, а не байтах: "±" и "…" занимают по два-три байта
+    size_t chars = 0;
+    for (unsigned char c : text)
+        if ((c & 0xC0) != 0x80) ++chars;
+    return chars >= width ? text + ' ' : text + string(width - chars, ' ');
+}
+
+// private: строка таблицы — среднее ± σ, медиана, диапазон и выбросы
+static void printRow(const string& name, const Summary& s) {
+    string spread = s.mean > 0 ? " (" + fixed2(100 * s.stddev / s.mean) + "%)" : "";
+    logMessageA(INFO, "    " + pad(name, 13) + pad(fixed2(s.mean) + " ± " + fixed2(s.stddev) + spread, 28) +
+                          pad(fixed2(s.median), 11) + pad(fixed2(s.min) + " … " + fixed2(s.max), 22) +
+                          std::to_string(s.outliers) + (s.severeOutliers ? " (" + std::to_string(s.severeOutliers) + " сильных)" : ""),
+                true);
+}
+
+struct Series {
+    std::vector<double> wall, user, system, rss;
+};
+
+// private: один замер в серию; false — запуск не удался или программа вернула ошибку
+static bool measure(const string& cmd, Series& series, int& code) {
+    RunStats r = runOnce(cmd, true);
+    if (!r.ok) {
+        logMessage(FAULT, "Не удалось запустить процесс: " + cmd);
+        code = -1;
+        return false;
+    }
+    if (r.code != 0 || !r.stopReason.empty()) {
+        string why = r.stopReason.empty() ? "завершился с кодом " + std::to_string(r.code) : "остановлен: " + r.stopReason;
+        logMessage(FAULT, "Запуск " + std::to_string(series.wall.size() + 1) + " " + why + ", замеры остановлены");
+        code = r.code;
+        return false;
+    }
+    series.wall.push_back(r.wallMs);
+    series.user.push_back(r.userMs);
+    series.system.push_back(r.systemMs);
+    series.rss.push_back(r.maxRssKb / 1024.0);
+    return true;
+}
+
+// private: прогрев — страничный кэш, частота CPU, ленивые загрузки библиотек
+static bool warmUp(const string& cmd) {
+    for (unsigned i = 0; i < arguments.warmup; ++i) {
+        if (!runOnce(cmd, true).ok) {
+            logMessage(FAULT, "Не удалось запустить процесс: " + cmd);
+            return false;
+        }
+    }
+    return true;
+}
+
+// private
+static void printHeader() {
+    logMessageA(INFO, "    " + pad("", 13) + pad("среднее ± σ", 28) + pad("медиана", 11) + pad("мин … макс", 22) +
+                          "выбросы", true);
+}
+
+// private
+static void printSeries(const Series& s, const string& prefix) {
+    printRow(prefix + "wall, ms", summarize(s.wall));
+    printRow(prefix + "user, ms", summarize(s.user));
+    printRow(prefix + "sys, ms", summarize(s.system));
+    printRow(prefix + "RSS, MB", summarize(s.rss));
+}
+
+int runBenchmark(const string& cmd, HistoryEntry* record) {
+    unsigned runs = arguments.bench;
+    logMessage(INFO, "Бенчмарк: " + std::to_string(arguments.warmup) + " прогрев, " + std::to_string(runs) + " замеров",
+               true, "⏱️");
+    if (!warmUp(cmd)) return -1;
+
+    Series series;
+    int code = 0;
+    for (unsigned i = 0; i < runs; ++i)
+        if (!measure(cmd, series, code)) return code;
+
+    Summary wallSummary = summarize(series.wall);
+    if (record) {
+        record->kind = "bench";
+        record->runs = runs;
+        record->wallMs = wallSummary.median;
+        record->wallStddevMs = wallSummary.stddev;
+        record->userMs = summarize(series.user).median;
+        record->systemMs = summarize(series.system).median;
+        record->maxRssKb = static_cast<unsigned long long>(summarize(series.rss).max * 1024);
+    }
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты бенчмарка (" + std::to_string(runs) + " запусков):", true);
+    printHeader();
+    printSeries(series, "");
+
+    if (runs < 5) logMessage(WARN, "Меньше 5 замеров — статистика ненадёжна", true);
+    if (wallSummary.outliers)
+        logMessage(WARN, "Есть выбросы по времени: фоновая нагрузка или холодные кэши, попробуйте больший -warmup",
+                   true);
+    else if (wallSummary.mean > 0 && wallSummary.stddev / wallSummary.mean > 0.05)
+        logMessage(WARN, "Разброс больше 5%: разницу в несколько процентов на таком шуме не увидеть", true);
+    return 0;
+}
+
+int runComparison(const string& cmdA, const string& labelA, const string& cmdB, const string& labelB) {
+    unsigned runs = arguments.bench;
+    logMessage(INFO, "Сравнение: A — " + labelA + ", B — " + labelB, true, "⚖️");
+    logMessageA(INFO, "    " + std::to_string(arguments.warmup) + " прогрев и " + std::to_string(runs) +
+                          " замеров каждого, запуски чередуются", true);
+    if (!warmUp(cmdA) || !warmUp(cmdB)) return -1;
+
+    // порядок в паре меняется каждый раз: дрейф (нагрев, частота, фон) ложится на оба варианта поровну
+    Series a, b;
+    int code = 0;
+    for (unsigned i = 0; i < runs; ++i) {
+        bool aFirst = i % 2 == 0;
+        if (!measure(aFirst ? cmdA : cmdB, aFirst ? a : b, code)) return code;
+        if (!measure(aFirst ? cmdB : cmdA, aFirst ? b : a, code)) return code;
+    }
+
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты сравнения (" + std::to_string(runs) + " пар запусков):", true);
+    printHeader();
+    printSeries(a, "A ");
+    printSeries(b, "B ");
+
+    // > 1 — A быстрее
+    Summary sa = summarize(a.wall), sb = summarize(b.wall);
+    double speedup = sa.mean > 0 ? sb.mean / sa.mean : 0;
+    Interval ci = bootstrapRatio(a.wall, b.wall, 0.95);
+    double u = 0, p = mannWhitneyP(a.wall, b.wall, &u);
+
+    auto times = [](double x) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.3f×", x);
+        return string(buf);
+    };
+    logMessageA(INFO, "", true);
+    logMessageA(INFO, "    Ускорение A относительно B (wall): " + times(speedup) + ", 95% ДИ [" + times(ci.low) + " … " +
+                          times(ci.high) + "]", true);
+    char pText[32];
+    snprintf(pText, sizeof(pText), "%.3g", p);
+    logMessageA(INFO, "    Манн–Уитни: U = " + fixed2(u) + ", p = " + pText, true);
+
+    bool significant = p < 0.05 && (ci.low > 1 || ci.high < 1);
+    if (!significant) logMessage(INFO, "Разница не значима: на этом шуме варианты неразличимы", true, "🟰");
+    else if (speedup > 1)
+        logMessage(INFO, "A быстрее B на " + fixed2((speedup - 1) * 100) + "%", true, "🚀");
+    else logMessage(INFO, "A медленнее B на " + fixed2((1 / speedup - 1) * 100) + "%", true, "🐢");
+    if (runs < 8) logMessage(WARN, "Меньше 8 пар — U-критерий почти не может показать значимость", true);
+    return 0;
+}
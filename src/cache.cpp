@@ -0,0 +1,131 @@
+#include "../cache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../output.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+static const size_t CHUNK = 1 << 20;
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+// private: FNV-1a по 8 байт за шаг; сдвиг переносит старшие биты слова в младшие биты хеша
+static void mix(uint64_t& hash, const char* data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * FNV_PRIME;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i) hash = (hash ^ static_cast<unsigned char>(data[i])) * FNV_PRIME;
+}
+
+// private: длина впереди, чтобы "ab"+"c" и "a"+"bc" давали разные ключи
+static void mixText(uint64_t& hash, const string& text) {
+    uint64_t size = text.size();
+    mix(hash, reinterpret_cast<const char*>(&size), sizeof(size));
+    mix(hash, text.data(), text.size());
+}
+
+// private
+static bool mixFile(uint64_t& hash, const string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::vector<char> buf(CHUNK);
+    size_t n;
+    while ((n = fread(buf.data(), 1, buf.size(), f)) > 0) mix(hash, buf.data(), n);
+    fclose(f);
+    return true;
+}
+
+// private: всё, что applyRunControls меняет у программы
+static string runSettings() {
+    return "mem=" + std::to_string(arguments.memoryLimitMb) + " as=" + std::to_string(arguments.addressLimitMb) +
+           " cpu=" + std::to_string(arguments.cpuLimit) + " files=" + std::to_string(arguments.filesLimit) +
+           " timeout=" + std::to_string(arguments.timeout) + " nice=" + std::to_string(arguments.nice) +
+           " ioprio=" + arguments.ioPriority + " cpus=" + arguments.cpus + " noaslr=" + std::to_string(arguments.noAslr);
+}
+
+// private
+static fs::path cacheDir(const string& key) {
+    return fs::path(arguments.buildFolder) / ".cache" / key;
+}
+
+string runCacheKey(const string& exe) {
+#ifdef _WIN32
+    logMessage(WARN, "Кэш запусков доступен только в Linux");
+    return "";
+#else
+    // вывод нужен целиком, а режимы -stdout его отбрасывают или обрезают
+    if (!arguments.stdoutMode.empty()) {
+        logMessage(WARN, "-cache не работает вместе с -stdout, запуск не кэшируется");
+        return "";
+    }
+    // вход из терминала или pipe в ключ не попадёт: повтор выдал бы старый вывод, не прочитав новый ввод
+    if (arguments.stdinFile.empty()) {
+        logMessage(WARN, "-cache работает только с -in: без файла входа запуск не кэшируется");
+        return "";
+    }
+    uint64_t hash = FNV_OFFSET;
+    if (!mixFile(hash, exe)) return "";
+    mixText(hash, arguments.exeArgs);
+    for (auto& name : arguments.cacheEnv) {
+        const char* value = getenv(name.c_str());
+        mixText(hash, value ? name + "=" + value : name);
+    }
+    // лимиты и настройки запуска меняют исход: программа под -mem-limit 64 может выйти с кодом 1
+    mixText(hash, runSettings());
+    if (!mixFile(hash, arguments.stdinFile)) return "";
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+    return key;
+#endif
+}
+
+bool replayRun(const string& key, int& code) {
+    fs::path dir = cacheDir(key);
+    std::ifstream in(dir / "code");
+    if (!(in >> code)) return false;
+    logMessage(INFO, "Результат из кэша (" + key + "): бинарник, аргументы и вход не изменились", true, "♻️");
+    logMessageA(INFO, "", true);
+    printFile((dir / "stdout").string(), stdout);
+    printFile((dir / "stderr").string(), stderr);
+    return true;
+}
+
+void prepareRunCache(const string& key) {
+    // запись без файла code — незаконченная, replayRun её не увидит
+    fs::path dir = cacheDir(key);
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+    // stdout одновременно виден в терминале и пишется в запись; stderr показывается после выхода
+    arguments.stdoutMode = "tee";
+    arguments.stdoutFile = (dir / "stdout").string();
+    arguments.stderrFile = (dir / "stderr").string();
+}
+
+void storeRunCache(const string& key, int code) {
+    fs::path dir = cacheDir(key);
+    std::error_code ec;
+    // остановленный лимитом или сигналом запуск не повторится так же
+    if (code < 0) {
+        fs::remove_all(dir, ec);
+        return;
+    }
+    std::ofstream out(dir / "code");
+    if (out << code << '\n') logMessage(INFO, "Результат сохранён в кэш: " + dir.string());
+    else logMessage(WARN, "Не удалось сохранить результат в кэш: " + dir.string());
+}
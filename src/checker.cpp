@@ -0,0 +1,41 @@
+#include "../checker.hpp"
+
+#include <cstdlib>
+#include <fstream>
+
+#include "../runner.hpp"
+
+using std::string;
+
+CheckResult runChecker(const string& checker, const string& input, const string& expected, const string& actual,
+                       const std::vector<int>& cpus) {
+    CheckResult result;
+    string report = actual + ".check";
+    // пути передаются как есть: вывод программы уже лежит в папке сборки, копировать нечего.
+    // Лимиты и -timeout решения к чекеру не относятся: большой вывод не должен давать CF
+    RunStats r = runOnce(checker + " \"" + input + "\" \"" + expected + "\" \"" + actual + "\"", true, {}, cpus, "",
+                         report, false);
+    if (!r.ok || !r.stopReason.empty() || r.code < 0 || r.code > 2) {
+        result.verdict = "CF";
+        result.comment = !r.ok ? "чекер не запустился"
+                         : !r.stopReason.empty() ? "чекер: " + r.stopReason
+                                                 : "чекер: код " + std::to_string(r.code);
+        return result;
+    }
+    result.verdict = r.code == 0 ? "OK" : r.code == 1 ? "WA" : "PE";
+    result.score = r.code == 0 ? 1 : 0;
+
+    std::ifstream in(report);
+    string line;
+    if (!std::getline(in, line)) return result;
+    char* end = nullptr;
+    double score = strtod(line.c_str(), &end);
+    if (end != line.c_str()) {
+        result.score = score;
+        line.erase(0, end - line.c_str());
+    }
+    size_t first = line.find_first_not_of(" \t");
+    result.comment = first == string::npos ? "" : line.substr(first);
+    if (!result.comment.empty() && result.comment.back() == '\r') result.comment.pop_back();
+    return result;
+}
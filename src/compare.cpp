@@ -0,0 +1,155 @@
+#include "../compare.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../args.hpp"
+
+using std::string;
+
+static const size_t CHUNK = 1 << 20;
+
+// файл, читаемый большими кусками в свой буфер
+struct Stream {
+    FILE* file = nullptr;
+    std::vector<char> buf;
+    size_t pos = 0, end = 0;
+    unsigned long long line = 1;
+};
+
+// private
+static bool openStream(Stream& s, const string& path) {
+    s.file = fopen(path.c_str(), "rb");
+    if (!s.file) return false;
+    // буфер stdio дал бы лишнее копирование: читаем сразу в свой
+    setvbuf(s.file, nullptr, _IONBF, 0);
+    s.buf.resize(CHUNK);
+    return true;
+}
+
+// private
+static void closeStream(Stream& s) {
+    if (s.file) fclose(s.file);
+    s.file = nullptr;
+}
+
+// private: следующий кусок; false — файл кончился
+static bool fill(Stream& s) {
+    s.pos = 0;
+    s.end = fread(s.buf.data(), 1, s.buf.size(), s.file);
+    return s.end > 0;
+}
+
+// private: следующий токен между пробельными символами; line — строка, где он начался
+static bool nextToken(Stream& s, string& token, unsigned long long& line) {
+    token.clear();
+    for (;;) {
+        if (s.pos == s.end && !fill(s)) return false;
+        char c = s.buf[s.pos];
+        if (!isspace(static_cast<unsigned char>(c))) break;
+        if (c == '\n') ++s.line;
+        ++s.pos;
+    }
+    line = s.line;
+    for (;;) {
+        if (s.pos == s.end && !fill(s)) return true;
+        size_t start = s.pos;
+        while (s.pos < s.end && !isspace(static_cast<unsigned char>(s.buf[s.pos]))) ++s.pos;
+        token.append(s.buf.data() + start, s.pos - start);
+        if (s.pos < s.end) return true;
+    }
+}
+
+// private: токен для сообщения, не длиннее 32 символов
+static string clip(const string& token) {
+    return token.size() <= 32 ? token : token.substr(0, 32) + "…";
+}
+
+// private
+static unsigned long long countLines(const char* data, size_t size) {
+    unsigned long long lines = 0;
+    for (const char* p = data; (p = static_cast<const char*>(memchr(p, '\n', data + size - p))); ++p) ++lines;
+    return lines;
+}
+
+// private: побайтно кусками по CHUNK; memcmp из libc сравнивает векторными инструкциями
+static CompareResult compareExact(Stream& expected, Stream& actual) {
+    unsigned long long offset = 0, line = 1;
+    for (;;) {
+        fill(expected);
+        fill(actual);
+        size_t n = std::min(expected.end, actual.end);
+        const char* a = expected.buf.data();
+        const char* b = actual.buf.data();
+        if (memcmp(a, b, n) != 0) {
+            // место расхождения: сначала блоками, потом побайтно
+            size_t i = 0;
+            while (i + 64 <= n && memcmp(a + i, b + i, 64) == 0) i += 64;
+            while (a[i] == b[i]) ++i;
+            line += countLines(a, i);
+            return {false, "строка " + std::to_string(line) + ", байт " + std::to_string(offset + i) +
+                               ": вывод отличается от ответа"};
+        }
+        if (expected.end != actual.end) {
+            line += countLines(a, n);
+            return {false, "строка " + std::to_string(line) + ": " +
+                               (actual.end < expected.end ? "вывод короче ответа" : "лишний вывод после ответа")};
+        }
+        if (n == 0) return {true, ""};
+        offset += n;
+        line += countLines(a, n);
+    }
+}
+
+// private: числа равны, если отличаются не больше чем на epsilon — абсолютно или относительно ответа
+static bool closeNumbers(const string& expected, const string& actual) {
+    char* endA = nullptr;
+    char* endB = nullptr;
+    double a = strtod(expected.c_str(), &endA);
+    double b = strtod(actual.c_str(), &endB);
+    if (*endA || *endB || endA == expected.c_str() || endB == actual.c_str()) return false;
+    if (std::isnan(a) || std::isnan(b)) return false;
+    double diff = std::fabs(a - b);
+    return diff <= arguments.epsilon || diff <= arguments.epsilon * std::fabs(a);
+}
+
+// private
+static CompareResult compareTokens(Stream& expected, Stream& actual, bool numbers) {
+    string a, b;
+    unsigned long long lineA = 1, lineB = 1;
+    for (;;) {
+        bool hasA = nextToken(expected, a, lineA);
+        bool hasB = nextToken(actual, b, lineB);
+        if (!hasA && !hasB) return {true, ""};
+        if (!hasB)
+            return {false, "строка " + std::to_string(actual.line) + ": вывод кончился, ожидалось «" + clip(a) + "»"};
+        if (!hasA) return {false, "строка " + std::to_string(lineB) + ": лишний вывод «" + clip(b) + "»"};
+        if (a == b || (numbers && closeNumbers(a, b))) continue;
+        return {false, "строка " + std::to_string(lineB) + ": ожидалось «" + clip(a) + "», получено «" + clip(b) + "»"};
+    }
+}
+
+CompareResult compareFiles(const string& expected, const string& actual) {
+    Stream e, a;
+    if (!openStream(e, expected)) return {false, "не удалось открыть " + expected};
+    if (!openStream(a, actual)) {
+        closeStream(e);
+        return {false, "не удалось открыть " + actual};
+    }
+    // совпадение байт в байт — самый частый случай, и его проверка самая дешёвая
+    CompareResult result = compareExact(e, a);
+    if (!result.same && arguments.compare != "exact") {
+        rewind(e.file);
+        rewind(a.file);
+        e.pos = e.end = a.pos = a.end = 0;
+        result = compareTokens(e, a, arguments.compare == "float");
+    }
+    closeStream(e);
+    closeStream(a);
+    return result;
+}
@@ -1,5 +1,6 @@
 #include "../config.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 #include "../args.hpp"
@@ -46,7 +47,7 @@ bool readConfig(const std::string& path, const std::string& script) {
         auto n = doc[key];
         if (n.is_sequence()) {
             value.clear();
-            for (auto& v : n.sequence())
+            for (auto& v : n.get_value_ref<const fkyaml::node::sequence_type&>())
                 if (v.is_string()) value.insert(v.get_value<string>());
         }
     };
@@ -75,6 +76,95 @@ bool readConfig(const std::string& path, const std::string& script) {
     extractBool("clear", arguments.clear);
     extractBool("downToC", arguments.downToC);
     extractString("build", arguments.buildFolder);
+    extractBool("smaps", arguments.smaps);
+    extractBool("perf", arguments.perf);
+    extractBool("topdown", arguments.topDown);
+    extractBool("heap", arguments.heap);
+    extractBool("locks", arguments.locks);
+
+    // true — трассировать всё время, число — процент времени
+    auto syscalls = doc["syscalls"];
+    if (syscalls.is_boolean()) arguments.syscalls = syscalls.get_value<bool>() ? 100 : 0;
+    else if (syscalls.is_integer()) {
+        auto value = syscalls.get_value<int64_t>();
+        arguments.syscalls = static_cast<unsigned>(value < 0 ? 0 : value > 100 ? 100 : value);
+    }
+
+    auto extractUnsigned = [&](const char* key, unsigned& value) {
+        auto n = doc[key];
+        if (n.is_integer() && n.get_value<int64_t>() >= 0) value = static_cast<unsigned>(n.get_value<int64_t>());
+    };
+    extractUnsigned("bench", arguments.bench);
+    extractUnsigned("warmup", arguments.warmup);
+
+    extractString("vs", arguments.compareWith);
+    if (extractString("vs-options", arguments.compareOptions)) arguments.compareBuild = true;
+
+    auto failIfSlower = doc["fail-if-slower"];
+    if (failIfSlower.is_integer()) arguments.failIfSlower = static_cast<double>(failIfSlower.get_value<int64_t>());
+    else if (failIfSlower.is_float_number()) arguments.failIfSlower = failIfSlower.get_value<double>();
+
+    auto timeout = doc["timeout"];
+    if (timeout.is_integer()) arguments.timeout = static_cast<double>(timeout.get_value<int64_t>());
+    else if (timeout.is_float_number()) arguments.timeout = timeout.get_value<double>();
+    extractUnsigned("cpu-limit", arguments.cpuLimit);
+    extractUnsigned("files-limit", arguments.filesLimit);
+    auto extractMegabytes = [&](const char* key, unsigned long long& value) {
+        auto n = doc[key];
+        if (n.is_integer() && n.get_value<int64_t>() >= 0) value = static_cast<unsigned long long>(n.get_value<int64_t>());
+    };
+    extractMegabytes("mem-limit", arguments.memoryLimitMb);
+    extractMegabytes("as-limit", arguments.addressLimitMb);
+
+    extractString("stdin", arguments.stdinFile);
+    extractBool("cache", arguments.cache);
+    extractArray("cache-env", arguments.cacheEnv);
+    extractString("compare", arguments.compare);
+    extractString("checker", arguments.checker);
+    auto epsilon = doc["epsilon"];
+    if (epsilon.is_float_number()) arguments.epsilon = epsilon.get_value<double>();
+    else if (epsilon.is_integer()) arguments.epsilon = static_cast<double>(epsilon.get_value<int64_t>());
+
+    extractString("stdout", arguments.stdoutMode);
+    if (extractString("stdout-file", arguments.stdoutFile) && arguments.stdoutMode.empty()) arguments.stdoutMode = "file";
+    extractUnsigned("stdout-tail", arguments.stdoutTail);
+    if (!arguments.stdoutTail) arguments.stdoutTail = 1;
+
+    extractString("threads-var", arguments.threadsVar);
+    extractString("cpus", arguments.cpus);
+    extractString("ioprio", arguments.ioPriority);
+    extractBool("no-aslr", arguments.noAslr);
+    auto nice = doc["nice"];
+    if (nice.is_integer()) arguments.nice = static_cast<int>(std::max<int64_t>(-20, std::min<int64_t>(19, nice.get_value<int64_t>())));
+
+    // matrix: args — варианты аргументов, env — переменная → список значений
+    auto matrix = doc["matrix"];
+    if (matrix.is_mapping()) {
+        auto scalar = [](const fkyaml::node& n) -> string {
+            if (n.is_string()) return n.get_value<string>();
+            if (n.is_integer()) return std::to_string(n.get_value<int64_t>());
+            if (n.is_float_number()) return std::to_string(n.get_value<double>());
+            if (n.is_boolean()) return n.get_value<bool>() ? "true" : "false";
+            return "";
+        };
+        auto values = [&](const fkyaml::node& n) {
+            std::vector<string> list;
+            if (n.is_sequence())
+                for (auto& v : n.get_value_ref<const fkyaml::node::sequence_type&>()) list.push_back(scalar(v));
+            else if (n.is_scalar()) list.push_back(scalar(n));
+            return list;
+        };
+        Matrix& m = arguments.matrix;
+        if (matrix.contains("args")) m.args = values(matrix["args"]);
+        if (matrix.contains("env") && matrix["env"].is_mapping()) {
+            m.env.clear();
+            for (auto& var : matrix["env"].get_value_ref<fkyaml::node::mapping_type&>())
+                if (var.first.is_string()) m.env.emplace_back(var.first.get_value<string>(), values(var.second));
+        }
+        if (matrix.contains("parallel") && matrix["parallel"].is_integer())
+            m.parallel = static_cast<unsigned>(std::max<int64_t>(1, matrix["parallel"].get_value<int64_t>()));
+        if (matrix.contains("output") && matrix["output"].is_string()) m.output = matrix["output"].get_value<string>();
+    }
 
     string launch;
     if (extractString("launch", launch)) {
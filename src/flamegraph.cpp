@@ -0,0 +1,131 @@
+#include "../flamegraph.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+using std::string;
+
+struct FrameNode {
+    string name;
+    unsigned long long value = 0;
+    std::map<string, std::unique_ptr<FrameNode>> children;
+};
+
+static const int WIDTH = 1200;
+static const int FRAME_HEIGHT = 16;
+static const int PADDING = 10;
+static const double CHAR_WIDTH = 7;  // моноширинный 12px
+
+bool writeFolded(const FoldedStacks& stacks, const string& path) {
+    std::ofstream f(path);
+    if (!f.is_open()) return false;
+    for (auto& s : stacks) f << s.first << ' ' << s.second << '\n';
+    return true;
+}
+
+// private
+static string escapeXml(const string& text) {
+    string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+// private: тёплая палитра, цвет стабилен для одного имени
+static string frameColor(const string& name) {
+    unsigned hash = 2166136261u;
+    for (unsigned char c : name) hash = (hash ^ c) * 16777619u;
+    int r = 205 + static_cast<int>(hash % 50);
+    int g = 80 + static_cast<int>((hash >> 8) % 150);
+    int b = static_cast<int>((hash >> 16) % 55);
+    return "rgb(" + std::to_string(r) + "," + std::to_string(g) + "," + std::to_string(b) + ")";
+}
+
+// private
+static int depthOf(const FrameNode& node) {
+    int depth = 0;
+    for (auto& c : node.children) depth = std::max(depth, depthOf(*c.second));
+    return depth + 1;
+}
+
+// private: корень внизу, потомки над родителем, ширина пропорциональна сэмплам
+static void drawNode(std::ofstream& f, const FrameNode& node, double x, int level, int height, double scale,
+                     unsigned long long total) {
+    double width = node.value * scale;
+    if (width < 0.3) return;
+    int y = height - PADDING - (level + 1) * FRAME_HEIGHT;
+
+    char percent[32];
+    snprintf(percent, sizeof(percent), "%.2f", 100.0 * node.value / total);
+    string name = escapeXml(node.name);
+    f << "<g><title>" << name << " (" << node.value << " сэмплов, " << percent << "%)</title>"
+      << "<rect x=\"" << x << "\" y=\"" << y << "\" width=\"" << width << "\" height=\"" << FRAME_HEIGHT - 1
+      << "\" fill=\"" << frameColor(node.name) << "\" rx=\"2\"/>";
+    size_t fits = static_cast<size_t>((width - 6) / CHAR_WIDTH);
+    if (fits >= 3) {
+        string label = node.name.size() <= fits ? node.name : node.name.substr(0, fits - 2) + "..";
+        f << "<text x=\"" << x + 3 << "\" y=\"" << y + FRAME_HEIGHT - 4 << "\">" << escapeXml(label) << "</text>";
+    }
+    f << "</g>\n";
+
+    // крупные вызовы — левее
+    std::vector<const FrameNode*> children;
+    for (auto& c : node.children) children.push_back(c.second.get());
+    std::sort(children.begin(), children.end(),
+              [](const FrameNode* a, const FrameNode* b) { return a->value > b->value; });
+    for (auto* c : children) {
+        drawNode(f, *c, x, level + 1, height, scale, total);
+        x += c->value * scale;
+    }
+}
+
+bool writeFlameGraph(const FoldedStacks& stacks, const string& path, const string& title) {
+    FrameNode root;
+    root.name = "all";
+    for (auto& s : stacks) {
+        root.value += s.second;
+        FrameNode* node = &root;
+        size_t start = 0;
+        while (start <= s.first.size()) {
+            size_t end = s.first.find(';', start);
+            if (end == string::npos) end = s.first.size();
+            auto& child = node->children[s.first.substr(start, end - start)];
+            if (!child) {
+                child = std::make_unique<FrameNode>();
+                child->name = s.first.substr(start, end - start);
+            }
+            child->value += s.second;
+            node = child.get();
+            start = end + 1;
+        }
+    }
+    if (root.value == 0) return false;
+
+    std::ofstream f(path);
+    if (!f.is_open()) return false;
+
+    int height = depthOf(root) * FRAME_HEIGHT + 2 * PADDING + 24;
+    double scale = static_cast<double>(WIDTH - 2 * PADDING) / root.value;
+    f << "<?xml version=\"1.0\" standalone=\"no\"?>\n"
+      << "<svg version=\"1.1\" width=\"" << WIDTH << "\" height=\"" << height
+      << "\" xmlns=\"http://www.w3.org/2000/svg\">\n"
+      << "<style>text{font-family:monospace;font-size:12px;fill:#000}g:hover rect{stroke:#000;stroke-width:0.5}"
+      << "</style>\n"
+      << "<rect width=\"100%\" height=\"100%\" fill=\"#f8f8f8\"/>\n"
+      << "<text x=\"" << WIDTH / 2 << "\" y=\"20\" text-anchor=\"middle\" style=\"font-size:16px\">"
+      << escapeXml(title) << "</text>\n";
+    drawNode(f, root, PADDING, 0, height, scale, root.value);
+    f << "</svg>\n";
+    return true;
+}
@@ -0,0 +1,268 @@
+#include "../history.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../rapidjson/document.h"
+#include "../rapidjson/stringbuffer.h"
+#include "../rapidjson/writer.h"
+#include "../stats.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace fs = std::filesystem;
+using std::string;
+
+// private: сколько прошлых запусков образуют скользящий baseline
+static const size_t ROLLING_RUNS = 5;
+
+// private
+static fs::path historyPath() { return fs::path(".crun") / "history.jsonl"; }
+
+// private: коммит рабочей копии; "-dirty" — есть незакоммиченные изменения
+static string currentCommit() {
+#ifdef _WIN32
+    FILE* pipe = popen("git describe --always --dirty 2>nul", "r");
+#else
+    FILE* pipe = popen("git describe --always --dirty 2>/dev/null", "r");
+#endif
+    if (!pipe) return "";
+    char buf[128] = {};
+    string commit;
+    if (fgets(buf, sizeof(buf), pipe)) commit = buf;
+    pclose(pipe);
+    while (!commit.empty() && (commit.back() == '\n' || commit.back() == '\r')) commit.pop_back();
+    return commit;
+}
+
+// private: записи с одинаковыми программой, режимом, опциями, аргументами и условиями сравнимы между собой
+static bool sameSetup(const HistoryEntry& a, const HistoryEntry& b) {
+    return a.name == b.name && a.kind == b.kind && a.options == b.options && a.args == b.args && a.setup == b.setup;
+}
+
+string runSetup() {
+    string setup;
+    auto add = [&](bool on, const string& flag) {
+        if (on) setup += (setup.empty() ? "" : " ") + flag;
+    };
+    // ptrace на каждом вызове или LD_PRELOAD-обёртки замедляют программу в разы
+    add(arguments.syscalls, "-syscalls " + std::to_string(arguments.syscalls));
+    add(arguments.profile, "-profile");
+    add(arguments.heap, "-heap");
+    add(arguments.locks, "-locks");
+    add(arguments.perf, "-perf");
+    add(arguments.topDown, "-topdown");
+    add(arguments.smaps, "-smaps");
+    add(!arguments.stdoutMode.empty(), "-stdout " + arguments.stdoutMode);
+    add(!arguments.stdinFile.empty(), "-in " + arguments.stdinFile);
+    add(!arguments.cpus.empty(), "-cpus " + arguments.cpus);
+    add(arguments.nice != 0, "-nice " + std::to_string(arguments.nice));
+    add(!arguments.ioPriority.empty(), "-ioprio " + arguments.ioPriority);
+    add(arguments.noAslr, "-no-aslr");
+    add(arguments.memoryLimitMb, "-mem-limit " + std::to_string(arguments.memoryLimitMb));
+    add(arguments.addressLimitMb, "-as-limit " + std::to_string(arguments.addressLimitMb));
+    return setup;
+}
+
+bool appendHistory(HistoryEntry& entry) {
+    entry.time = static_cast<long long>(std::time(nullptr));
+    entry.commit = currentCommit();
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> w(buffer);
+    w.StartObject();
+    w.Key("time");
+    w.Int64(entry.time);
+    w.Key("commit");
+    w.String(entry.commit.c_str());
+    w.Key("name");
+    w.String(entry.name.c_str());
+    w.Key("kind");
+    w.String(entry.kind.c_str());
+    w.Key("options");
+    w.String(entry.options.c_str());
+    w.Key("args");
+    w.String(entry.args.c_str());
+    w.Key("setup");
+    w.String(entry.setup.c_str());
+    w.Key("runs");
+    w.Uint(entry.runs);
+    w.Key("code");
+    w.Int(entry.code);
+    w.Key("wallMs");
+    w.Double(entry.wallMs);
+    w.Key("wallStddevMs");
+    w.Double(entry.wallStddevMs);
+    w.Key("userMs");
+    w.Double(entry.userMs);
+    w.Key("systemMs");
+    w.Double(entry.systemMs);
+    w.Key("maxRssKb");
+    w.Uint64(entry.maxRssKb);
+    if (entry.instructions && entry.cycles) {
+        w.Key("instructions");
+        w.Uint64(entry.instructions);
+        w.Key("cycles");
+        w.Uint64(entry.cycles);
+    }
+    w.EndObject();
+
+    std::error_code ec;
+    fs::create_directories(historyPath().parent_path(), ec);
+    // только дописываем: старые записи никогда не переписываются
+    std::ofstream out(historyPath(), std::ios::app);
+    if (!out) {
+        logMessage(WARN, "Не удалось записать историю: " + historyPath().string());
+        return false;
+    }
+    out << buffer.GetString() << '\n';
+    return true;
+}
+
+std::vector<HistoryEntry> readHistory() {
+    std::vector<HistoryEntry> entries;
+    std::ifstream in(historyPath());
+    string line;
+    while (std::getline(in, line)) {
+        rapidjson::Document d;
+        // повреждённые строки (например, оборванная запись) пропускаются
+        if (d.Parse(line.c_str()).HasParseError() || !d.IsObject()) continue;
+
+        auto text = [&](const char* key) { return d.HasMember(key) && d[key].IsString() ? d[key].GetString() : ""; };
+        auto number = [&](const char* key) { return d.HasMember(key) && d[key].IsNumber() ? d[key].GetDouble() : 0.0; };
+        auto count = [&](const char* key) {
+            return d.HasMember(key) && d[key].IsUint64() ? d[key].GetUint64() : 0ULL;
+        };
+
+        HistoryEntry e;
+        e.time = d.HasMember("time") && d["time"].IsInt64() ? d["time"].GetInt64() : 0;
+        e.commit = text("commit");
+        e.name = text("name");
+        e.kind = text("kind");
+        e.options = text("options");
+        e.args = text("args");
+        e.setup = text("setup");
+        e.runs = static_cast<unsigned>(count("runs"));
+        e.code = d.HasMember("code") && d["code"].IsInt() ? d["code"].GetInt() : 0;
+        e.wallMs = number("wallMs");
+        e.wallStddevMs = number("wallStddevMs");
+        e.userMs = number("userMs");
+        e.systemMs = number("systemMs");
+        e.maxRssKb = count("maxRssKb");
+        e.instructions = count("instructions");
+        e.cycles = count("cycles");
+        entries.push_back(e);
+    }
+    return entries;
+}
+
+bool slowerThanHistory(const HistoryEntry& entry, double percent) {
+    std::vector<double> previous;
+    auto entries = readHistory();
+    for (auto it = entries.rbegin(); it != entries.rend() && previous.size() < ROLLING_RUNS; ++it)
+        if (it->code == 0 && it->wallMs > 0 && sameSetup(*it, entry)) previous.push_back(it->wallMs);
+
+    if (previous.empty()) {
+        logMessage(INFO, "В истории нет запусков с теми же опциями — сравнивать не с чем", true, "📈");
+        return false;
+    }
+
+    // медиана устойчива к одному неудачному прошлому запуску
+    double baseline = summarize(previous).median;
+    double change = baseline > 0 ? (entry.wallMs / baseline - 1) * 100 : 0;
+    string text = "Время " + fixed2(entry.wallMs) + " ms против " + fixed2(baseline) + " ms (медиана " +
+                  std::to_string(previous.size()) + " прошлых запусков): " + (change >= 0 ? "+" : "") +
+                  fixed2(change) + "%";
+    if (change > percent) {
+        logMessage(FAULT, text + ", порог " + fixed2(percent) + "%");
+        return true;
+    }
+    logMessage(INFO, text, true, "📈");
+    return false;
+}
+
+int showHistory(int argc, char* argv[]) {
+    string name;
+    size_t limit = 20;
+    for (int i = 0; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) limit = static_cast<size_t>(std::max(1, atoi(argv[++i])));
+        else name = arg;
+    }
+
+    auto entries = readHistory();
+    if (entries.empty()) {
+        logMessage(INFO, "История пуста: " + historyPath().string(), true, "📈");
+        return 0;
+    }
+
+    // группы сравнимых запусков в порядке первого появления
+    using Key = std::tuple<string, string, string, string, string>;
+    std::map<Key, std::vector<const HistoryEntry*>> groups;
+    std::vector<Key> order;
+    for (auto& e : entries) {
+        if (!name.empty() && e.name != name) continue;
+        Key key{e.name, e.kind, e.options, e.args, e.setup};
+        if (!groups.count(key)) order.push_back(key);
+        groups[key].push_back(&e);
+    }
+    if (order.empty()) {
+        logMessage(INFO, "Нет запусков " + name, true, "📈");
+        return 0;
+    }
+
+    for (auto& key : order) {
+        auto& group = groups[key];
+        const HistoryEntry& first = *group.front();
+        string title = first.name + " (" + first.kind;
+        if (!first.options.empty()) title += ", " + first.options;
+        if (!first.setup.empty()) title += ", " + first.setup;
+        if (!first.args.empty()) title += ", -- " + first.args;
+        logMessage(INFO, title + "):", true, "📈");
+
+        size_t from = group.size() > limit ? group.size() - limit : 0;
+        for (size_t i = from; i < group.size(); ++i) {
+            const HistoryEntry& e = *group[i];
+            char date[32] = "?";
+            std::time_t t = static_cast<std::time_t>(e.time);
+            if (std::tm* tm = std::localtime(&t)) std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M", tm);
+
+            char row[256];
+            snprintf(row, sizeof(row), "    %s  %-14s %10.2f ms", date, e.commit.empty() ? "-" : e.commit.c_str(),
+                     e.wallMs);
+            string line = row;
+            if (e.wallStddevMs > 0) line += " ± " + fixed2(e.wallStddevMs);
+            if (i > 0 && group[i - 1]->wallMs > 0) {
+                double change = (e.wallMs / group[i - 1]->wallMs - 1) * 100;
+                line += string("  ") + (change >= 0 ? "+" : "") + fixed2(change) + "%";
+            }
+            line += "  RSS " + fixed2(e.maxRssKb / 1024.0) + " MB";
+            if (e.cycles) line += "  IPC " + fixed2(static_cast<double>(e.instructions) / e.cycles);
+            if (e.code != 0) line += "  код " + std::to_string(e.code);
+            logMessageA(INFO, line, true);
+        }
+
+        // тренд: последний запуск против медианы предыдущих в окне
+        std::vector<double> previous;
+        for (size_t i = from; i + 1 < group.size(); ++i)
+            if (group[i]->code == 0 && group[i]->wallMs > 0) previous.push_back(group[i]->wallMs);
+        if (previous.size() >= 2) {
+            double baseline = summarize(previous).median;
+            double change = (group.back()->wallMs / baseline - 1) * 100;
+            logMessageA(INFO, "    Последний запуск против медианы предыдущих: " + string(change >= 0 ? "+" : "") +
+                                  fixed2(change) + "%", true);
+        }
+    }
+    return 0;
+}
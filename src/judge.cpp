@@ -0,0 +1,241 @@
+#include "../judge.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../args.hpp"
+#include "../checker.hpp"
+#include "../compare.hpp"
+#include "../logger.hpp"
+#include "../runner.hpp"
+#include "../tuning.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+struct TestCase {
+    string name;
+    fs::path input, expected, output;  // expected пуст, если ответа нет
+    string verdict;                    // OK, WA, PE, TL, ML, RE, CF; "-" — ответа нет, сравнить не с чем
+    string comment;
+    double score = 0;
+    double wallMs = 0;
+    unsigned long long maxRssKb = 0;
+};
+
+// private: "2" < "10" — номера тестов сравниваются как числа
+static bool naturalLess(const string& a, const string& b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (isdigit(static_cast<unsigned char>(a[i])) && isdigit(static_cast<unsigned char>(b[j]))) {
+            size_t si = i, sj = j;
+            while (i < a.size() && isdigit(static_cast<unsigned char>(a[i]))) ++i;
+            while (j < b.size() && isdigit(static_cast<unsigned char>(b[j]))) ++j;
+            string na = a.substr(si, i - si), nb = b.substr(sj, j - sj);
+            na.erase(0, std::min(na.find_first_not_of('0'), na.size()));
+            nb.erase(0, std::min(nb.find_first_not_of('0'), nb.size()));
+            if (na.size() != nb.size()) return na.size() < nb.size();
+            if (na != nb) return na < nb;
+        }
+        else {
+            if (a[i] != b[j]) return a[i] < b[j];
+            ++i;
+            ++j;
+        }
+    }
+    return a.size() - i < b.size() - j;
+}
+
+// private: пары name.in + name.out (или name.ans)
+static std::vector<TestCase> findCases(const fs::path& dir) {
+    std::vector<TestCase> cases;
+    std::error_code ec;
+    for (auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".in") continue;
+        TestCase c;
+        c.name = entry.path().stem().string();
+        c.input = entry.path();
+        for (const char* ext : {".out", ".ans"}) {
+            fs::path answer = entry.path();
+            answer.replace_extension(ext);
+            if (fs::exists(answer)) {
+                c.expected = answer;
+                break;
+            }
+        }
+        cases.push_back(c);
+    }
+    std::sort(cases.begin(), cases.end(), [](const TestCase& a, const TestCase& b) { return naturalLess(a.name, b.name); });
+    return cases;
+}
+
+// private: запуск на одном тесте и вердикт; false — вердикт вынесет чекер
+static bool judgeCase(const string& cmd, TestCase& c, const std::vector<int>& cpus, bool checked) {
+    RunStats r = runOnce(cmd, true, {}, cpus, c.input.string(), c.output.string());
+    c.wallMs = r.wallMs;
+    c.maxRssKb = r.maxRssKb;
+    if (!r.ok) {
+        c.verdict = "RE";
+        c.comment = "не удалось запустить";
+    }
+    else if (r.timedOut) {
+        c.verdict = "TL";
+        c.comment = "дольше " + fixed2(arguments.timeout) + " s";
+    }
+    else if (r.memoryExceeded) {
+        c.verdict = "ML";
+        c.comment = r.stopReason;
+    }
+    else if (r.code != 0 || !r.stopReason.empty()) {
+        c.verdict = "RE";
+        c.comment = r.stopReason.empty() ? "код " + std::to_string(r.code) : r.stopReason;
+    }
+    else if (c.expected.empty()) {
+        c.verdict = "-";
+        c.comment = "нет ответа";
+    }
+    else if (checked) return false;
+    else {
+        CompareResult result = compareFiles(c.expected.string(), c.output.string());
+        c.verdict = result.same ? "OK" : "WA";
+        c.comment = result.difference;
+        c.score = result.same ? 1 : 0;
+    }
+    return true;
+}
+
+int runJudge(const string& cmd, const string& checker) {
+    fs::path dir = arguments.judgeDir;
+    std::vector<TestCase> cases = findCases(dir);
+    if (cases.empty()) {
+        logMessage(FAULT, "В " + dir.string() + " нет тестов *.in");
+        return 1;
+    }
+
+    // вывод каждого теста остаётся в папке сборки: его можно посмотреть после WA
+    fs::path outputDir = fs::path(arguments.buildFolder) / (arguments.name + ".judge");
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+    for (auto& c : cases) c.output = outputDir / (c.name + ".out");
+
+    // без лимита одно зацикливание остановило бы весь прогон
+    if (arguments.timeout <= 0) arguments.timeout = 10;
+    std::vector<int> cpus = runCpus();
+    // чекеры на тех же CPU, что и тесты, раздували бы их время вплоть до TL: им отводится четверть CPU
+    // (хотя бы один); на одном CPU чекер запускается после теста в том же потоке
+    size_t reserved = !checker.empty() && cpus.size() > 1 ? std::max<size_t>(1, cpus.size() / 4) : 0;
+    std::vector<int> checkerCpus(cpus.end() - reserved, cpus.end());
+    cpus.resize(cpus.size() - reserved);
+    unsigned parallel = static_cast<unsigned>(std::max<size_t>(1, std::min(cpus.size(), cases.size())));
+
+    logMessage(INFO, "Тестирование: " + std::to_string(cases.size()) + " тестов из " + dir.string() + ", " +
+                         std::to_string(parallel) + " одновременно, лимит " + fixed2(arguments.timeout) + " s" +
+                         (arguments.memoryLimitMb ? ", " + std::to_string(arguments.memoryLimitMb) + " MB" : "") +
+                         ", сравнение " + (checker.empty() ? arguments.compare : "чекером") +
+                         (reserved ? " на " + std::to_string(reserved) + " отдельных CPU" : ""), true, "⚖️");
+
+    // чекеры работают в своих потоках и проверяют готовые тесты, пока следующие уже запускаются
+    std::mutex queueLock;
+    std::condition_variable queued;
+    std::deque<size_t> pending;
+    bool closed = false;
+    auto check = [&](TestCase& c, const std::vector<int>& own) {
+        CheckResult result = runChecker(checker, c.input.string(), c.expected.string(), c.output.string(), own);
+        c.verdict = result.verdict;
+        c.score = result.score;
+        c.comment = result.comment;
+    };
+    auto checkWorker = [&]() {
+        for (;;) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(queueLock);
+                queued.wait(lock, [&]() { return closed || !pending.empty(); });
+                if (pending.empty()) return;
+                i = pending.front();
+                pending.pop_front();
+            }
+            check(cases[i], checkerCpus);
+        }
+    };
+
+    // каждый поток берёт следующий тест и запускает его на своём CPU
+    std::atomic<size_t> next{0};
+    auto worker = [&](unsigned index) {
+        std::vector<int> own;
+        if (parallel > 1 || reserved) own.push_back(cpus[index]);
+        for (size_t i; (i = next++) < cases.size();) {
+            if (judgeCase(cmd, cases[i], own, !checker.empty())) continue;
+            if (!reserved) {
+                check(cases[i], own);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(queueLock);
+            pending.push_back(i);
+            queued.notify_one();
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads, checkers;
+    for (size_t i = 0; i < reserved; ++i) checkers.emplace_back(checkWorker);
+    for (unsigned i = 1; i < parallel; ++i) threads.emplace_back(worker, i);
+    worker(0);
+    for (auto& t : threads) t.join();
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        closed = true;
+    }
+    queued.notify_all();
+    for (auto& t : checkers) t.join();
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t width = 4;
+    for (auto& c : cases) width = std::max(width, c.name.size());
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты тестирования:", true);
+    logMessageA(INFO, "    " + string("тест") + string(width - 4, ' ') + "  вердикт   время, ms  память, MB" +
+                          (checker.empty() ? "" : "   балл"), true);
+    std::map<string, unsigned> verdicts;
+    double maxMs = 0;
+    unsigned long long maxRssKb = 0;
+    double score = 0;
+    for (auto& c : cases) {
+        ++verdicts[c.verdict];
+        score += c.score;
+        maxMs = std::max(maxMs, c.wallMs);
+        maxRssKb = std::max(maxRssKb, c.maxRssKb);
+        char row[96];
+        snprintf(row, sizeof(row), "  %-7s %10.2f %11.2f", c.verdict.c_str(), c.wallMs, c.maxRssKb / 1024.0);
+        string line = "    " + c.name + string(width - c.name.size(), ' ') + row;
+        if (!checker.empty()) line += "  " + string(c.score < 10 ? " " : "") + fixed2(c.score);
+        if (!c.comment.empty()) line += "  " + c.comment;
+        logMessageA(c.verdict == "OK" || c.verdict == "-" ? INFO : WARN, line, true);
+    }
+
+    string counts;
+    for (auto& v : verdicts) counts += (counts.empty() ? "" : ", ") + v.first + " " + std::to_string(v.second);
+    unsigned passed = verdicts["OK"];
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Пройдено " + std::to_string(passed) + " из " + std::to_string(cases.size()) + " (" + counts + ")",
+               true, passed == cases.size() ? "✅" : "❌");
+    if (!checker.empty())
+        logMessageA(INFO, "    Баллы: " + fixed2(score) + " из " + std::to_string(cases.size()), true);
+    logMessageA(INFO, "    Самый долгий тест: " + fixed2(maxMs) + " ms, больше всего памяти: " +
+                          fixed2(maxRssKb / 1024.0) + " MB", true);
+    logMessageA(INFO, "    Всего: " + fixed2(totalMs) + " ms, " + fixed2(cases.size() * 1000.0 / totalMs) + " тестов/с", true);
+    logMessageA(INFO, "    Вывод программы: " + outputDir.string(), true);
+
+    bool failed = false;
+    for (auto& c : cases) failed = failed || (c.verdict != "OK" && c.verdict != "-");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+#include "../load.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../monitor.hpp"
+#include "../runner.hpp"
+#include "../stats.hpp"
+#include "../tuning.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+extern char** environ;
+#endif
+
+using std::string;
+
+struct Instance {
+    double wallMs = 0;  // от общего старта до завершения
+    double userMs = 0, systemMs = 0;
+    unsigned long long maxRssKb = 0;
+    int code = -1;
+    bool ok = false;
+    bool timedOut = false;  // убит по -timeout
+};
+
+// private: команда экземпляра — "{i}" заменяется его номером
+static string instanceCommand(const string& cmd, unsigned index) {
+    string result = cmd;
+    for (size_t pos = 0; (pos = result.find("{i}", pos)) != string::npos;) {
+        result.replace(pos, 3, std::to_string(index));
+        pos += std::to_string(index).size();
+    }
+    return result;
+}
+
+#ifndef _WIN32
+// private: rusage завершившегося экземпляра
+static void takeUsage(Instance& inst, int status, const struct rusage& usage) {
+    inst.code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    inst.userMs = usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0;
+    inst.systemMs = usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+    inst.maxRssKb = static_cast<unsigned long long>(usage.ru_maxrss);
+    inst.ok = true;
+}
+#endif
+
+int runLoad(const string& cmd) {
+    unsigned count = arguments.load;
+    std::vector<Instance> instances(count);
+    MonitoringResult result{};
+    bool monitored = false;
+    logMessage(INFO, "Нагрузка: " + std::to_string(count) + " экземпляров одновременно, stdout отбрасывается", true,
+               "🏋️");
+
+    std::chrono::steady_clock::time_point start;
+#ifdef _WIN32
+    // без общего gate и cgroup: каждый экземпляр запускается и замеряется своим потоком
+    start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < count; ++i)
+        threads.emplace_back([&, i]() {
+            RunStats r = runOnce(instanceCommand(cmd, i), true, {"CRUN_INSTANCE=" + std::to_string(i)});
+            Instance& inst = instances[i];
+            inst.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            inst.userMs = r.userMs;
+            inst.systemMs = r.systemMs;
+            inst.maxRssKb = r.maxRssKb;
+            inst.code = r.code;
+            inst.ok = r.ok;
+            inst.timedOut = r.timedOut;
+        });
+    for (auto& t : threads) t.join();
+#else
+    // общая cgroup считает сумму всех экземпляров, поэтому memory.max в ней не годится как лимит каждого
+    if (arguments.memoryLimitMb)
+        logMessage(WARN, "В crun load -mem-limit ограничивает адресное пространство каждого экземпляра (RLIMIT_AS)",
+                   true);
+    std::vector<string> baseEnv;
+    for (char** e = environ; *e; ++e) baseEnv.push_back(*e);
+    int nul = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    // все экземпляры стоят на своих gate, пока не готовы cgroup и монитор, и стартуют разом
+    std::vector<pid_t> pids;
+    std::vector<int> gates;
+    for (unsigned i = 0; i < count; ++i) {
+        std::vector<string> env = baseEnv;
+        setEnvVar(env, "CRUN_INSTANCE", std::to_string(i));
+        ChildSetup setup;
+        setup.stdoutFd = nul;
+        setup.stdinFd = openRunInput();
+        applyRunControls(setup);
+        int gate = -1;
+        pid_t pid = spawnGated(instanceCommand(cmd, i), env, setup, gate);
+        if (setup.stdinFd >= 0) close(setup.stdinFd);
+        if (pid < 0) break;
+        pids.push_back(pid);
+        gates.push_back(gate);
+    }
+    if (nul >= 0) close(nul);
+    if (pids.size() < count) {
+        logMessage(FAULT, "Удалось запустить только " + std::to_string(pids.size()) + " из " + std::to_string(count) +
+                              " экземпляров");
+        for (size_t i = 0; i < pids.size(); ++i) {
+            kill(pids[i], SIGKILL);
+            close(gates[i]);
+            while (waitpid(pids[i], nullptr, 0) < 0 && errno == EINTR) {}
+        }
+        return -1;
+    }
+
+    // общая cgroup даёт суммы CPU и пик памяти всех экземпляров; без неё монитор видит только первый
+    string cgroup = createRunCgroup();
+    for (size_t i = 0; i < pids.size() && !cgroup.empty(); ++i)
+        if (!attachToCgroup(cgroup, pids[i])) {
+            // подключённые раньше возвращаем: занятую cgroup не удалить, а суммы были бы неполными
+            for (size_t j = 0; j < i; ++j) detachFromCgroup(cgroup, pids[j]);
+            removeRunCgroup(cgroup);
+            cgroup.clear();
+        }
+    monitorProcess(pids[0], result, cgroup);
+    monitored = true;
+
+    start = std::chrono::steady_clock::now();
+    for (int gate : gates) close(gate);
+
+    // экземпляр отмечается завершённым до освобождения pid: сторож -timeout не убьёт чужой процесс
+    std::mutex doneLock;
+    std::condition_variable allDone;
+    std::vector<bool> done(count, false);
+    unsigned finished = 0;
+    std::thread deadline;
+    if (arguments.timeout > 0)
+        deadline = std::thread([&]() {
+            std::unique_lock<std::mutex> lock(doneLock);
+            if (allDone.wait_for(lock, std::chrono::duration<double>(arguments.timeout), [&]() { return finished == count; }))
+                return;
+            for (unsigned i = 0; i < count; ++i)
+                if (!done[i]) {
+                    instances[i].timedOut = true;
+                    kill(pids[i], SIGKILL);
+                }
+            // потомки экземпляров тоже не должны пережить лимит
+            killRunCgroup(cgroup);
+        });
+
+    // первый экземпляр не освобождаем до конца: по нему монитор понимает, что замер ещё идёт
+    std::vector<std::thread> waiters;
+    for (unsigned i = 0; i < count; ++i)
+        waiters.emplace_back([&, i]() {
+            Instance& inst = instances[i];
+            siginfo_t info{};
+            while (waitid(P_PID, pids[i], &info, WEXITED | WNOWAIT) != 0 && errno == EINTR) {}
+            inst.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            {
+                std::lock_guard<std::mutex> lock(doneLock);
+                done[i] = true;
+                if (++finished == count) allDone.notify_one();
+            }
+            if (i == 0) return;
+            int status = 0;
+            struct rusage usage {};
+            while (wait4(pids[i], &status, 0, &usage) < 0 && errno == EINTR) {}
+            takeUsage(inst, status, usage);
+        });
+    for (auto& t : waiters) t.join();
+    if (deadline.joinable()) deadline.join();
+    shutdownMonitor();
+
+    int status = 0;
+    struct rusage usage {};
+    while (wait4(pids[0], &status, 0, &usage) < 0 && errno == EINTR) {}
+    takeUsage(instances[0], status, usage);
+    removeRunCgroup(cgroup);
+#endif
+
+    std::vector<double> latency, rss;
+    double userMs = 0, systemMs = 0, totalMs = 0;
+    unsigned long long rssSumKb = 0;
+    unsigned failed = 0, timedOut = 0;
+    for (auto& inst : instances) {
+        if (!inst.ok || inst.code != 0) ++failed;
+        if (inst.timedOut) ++timedOut;
+        if (!inst.ok) continue;
+        latency.push_back(inst.wallMs);
+        rss.push_back(inst.maxRssKb / 1024.0);
+        userMs += inst.userMs;
+        systemMs += inst.systemMs;
+        rssSumKb += inst.maxRssKb;
+        totalMs = std::max(totalMs, inst.wallMs);
+    }
+    Summary l = summarize(latency), r = summarize(rss);
+
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты нагрузки:", true);
+    logMessageA(INFO, "    Общее время:      " + fixed2(totalMs) + " ms (до завершения последнего)", true);
+    if (totalMs > 0)
+        logMessageA(INFO, "    Пропускная способность: " + fixed2(latency.size() * 1000.0 / totalMs) + " запусков/с",
+                    true);
+    logMessageA(INFO, "    Задержка, ms:     мин " + fixed2(l.min) + ", медиана " + fixed2(l.median) + ", p90 " +
+                          fixed2(l.p90) + ", p99 " + fixed2(l.p99) + ", макс " + fixed2(l.max), true);
+    logMessageA(INFO, "                      среднее " + fixed2(l.mean) + " ± " + fixed2(l.stddev), true);
+    logMessageA(INFO, "    CPU user:         " + fixed2(userMs) + " ms", true);
+    logMessageA(INFO, "    CPU system:       " + fixed2(systemMs) + " ms", true);
+    if (totalMs > 0)
+        logMessageA(INFO, "    Занято ядер:      " + fixed2((userMs + systemMs) / totalMs) + " в среднем", true);
+    if (monitored && result.cgroup) logMessageA(INFO, "    CPU max:          " + std::to_string(result.cpuMax) + "%", true);
+    logMessageA(INFO, "    RSS экземпляра:   медиана " + fixed2(r.median) + " MB, макс " + fixed2(r.max) + " MB", true);
+    if (monitored && result.cgroup)
+        logMessageA(INFO, "    RAM всех сразу:   " + std::to_string(result.ramMax) + " MB (пик cgroup)", true);
+    else logMessageA(INFO, "    RAM всех сразу:   до " + fixed2(rssSumKb / 1024.0) + " MB (сумма пиков)", true);
+
+    if (timedOut)
+        logMessage(FAULT, std::to_string(timedOut) + " из " + std::to_string(count) +
+                              " экземпляров остановлены: превышен лимит времени " + fixed2(arguments.timeout) + " s");
+    if (failed) {
+        logMessage(WARN, std::to_string(failed) + " из " + std::to_string(count) + " экземпляров завершились с ошибкой",
+                   true);
+        return 1;
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "../logger.hpp"
 
+#include <cstdio>
 #include <iostream>
 
 #include "../args.hpp"
@@ -68,4 +69,10 @@ void logMessage(const LogLevel& level, const string& msg, bool always) {
     logMessage(level, msg, always, getPrefix(level));
 }
 
-void logMessageA(const LogLevel& level, const string& msg, bool always) { logMessage(level, msg, always, ""); }
\ No newline at end of file
+void logMessageA(const LogLevel& level, const string& msg, bool always) { logMessage(level, msg, always, ""); }
+
+string fixed2(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.2f", value);
+    return buf;
+}
@@ -0,0 +1,233 @@
+#include "../matrix.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../rapidjson/prettywriter.h"
+#include "../rapidjson/stringbuffer.h"
+#include "../runner.hpp"
+#include "../stats.hpp"
+#include "../tuning.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+struct Cell {
+    string args;                  // дописываются к команде
+    std::vector<string> values;   // значения переменных matrix.env по порядку
+    std::vector<string> env;      // KEY=value
+    unsigned runs = 0;
+    int code = 0;
+    double wallMs = 0, wallStddevMs = 0, userMs = 0, systemMs = 0;
+    unsigned long long maxRssKb = 0;
+    bool ok = false;
+};
+
+// private: декартово произведение matrix.args × значений каждой переменной matrix.env
+static std::vector<Cell> buildCells(const Matrix& m) {
+    std::vector<Cell> cells;
+    if (m.args.empty()) cells.emplace_back();
+    for (auto& args : m.args) {
+        Cell cell;
+        cell.args = args;
+        cells.push_back(cell);
+    }
+    for (auto& var : m.env) {
+        if (var.second.empty()) continue;
+        std::vector<Cell> next;
+        for (auto& cell : cells)
+            for (auto& value : var.second) {
+                Cell c = cell;
+                c.values.push_back(value);
+                c.env.push_back(var.first + "=" + value);
+                next.push_back(c);
+            }
+        cells.swap(next);
+    }
+    return cells;
+}
+
+// private: несколько замеров одной ячейки; время — медиана, RSS — максимум
+static void measureCell(const string& cmd, Cell& cell, unsigned runs, const std::vector<int>& cpus) {
+    string command = cell.args.empty() ? cmd : cmd + " " + cell.args;
+    std::vector<double> wall, user, system;
+    for (unsigned i = 0; i < runs; ++i) {
+        RunStats r = runOnce(command, true, cell.env, cpus);
+        if (!r.ok) return;
+        cell.code = r.code;
+        wall.push_back(r.wallMs);
+        user.push_back(r.userMs);
+        system.push_back(r.systemMs);
+        cell.maxRssKb = std::max(cell.maxRssKb, r.maxRssKb);
+        if (r.code != 0) break;
+    }
+    Summary s = summarize(wall);
+    cell.runs = static_cast<unsigned>(wall.size());
+    cell.wallMs = s.median;
+    cell.wallStddevMs = s.stddev;
+    cell.userMs = summarize(user).median;
+    cell.systemMs = summarize(system).median;
+    cell.ok = true;
+}
+
+// private: CPU% — сколько ядер в среднем было занято за время работы
+static double cpuPercent(const Cell& cell) {
+    return cell.wallMs > 0 ? 100 * (cell.userMs + cell.systemMs) / cell.wallMs : 0;
+}
+
+// private
+static string csvField(const string& text) {
+    if (text.find_first_of(",\"\n ") == string::npos) return text;
+    string quoted = "\"";
+    for (char c : text) quoted += c == '"' ? string("\"\"") : string(1, c);
+    return quoted + "\"";
+}
+
+// private
+static bool writeCsv(const fs::path& path, const Matrix& m, const std::vector<Cell>& cells) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "args";
+    for (auto& var : m.env) out << ',' << csvField(var.first);
+    out << ",runs,code,wall_ms,wall_stddev_ms,user_ms,sys_ms,cpu_percent,max_rss_kb\n";
+    for (auto& c : cells) {
+        out << csvField(c.args);
+        for (auto& value : c.values) out << ',' << csvField(value);
+        out << ',' << c.runs << ',' << c.code << ',' << fixed2(c.wallMs) << ',' << fixed2(c.wallStddevMs) << ','
+            << fixed2(c.userMs) << ',' << fixed2(c.systemMs) << ',' << fixed2(cpuPercent(c)) << ',' << c.maxRssKb
+            << '\n';
+    }
+    return true;
+}
+
+// private
+static bool writeJson(const fs::path& path, const Matrix& m, const std::vector<Cell>& cells) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> w(buffer);
+    w.StartArray();
+    for (auto& c : cells) {
+        w.StartObject();
+        w.Key("args");
+        w.String(c.args.c_str());
+        w.Key("env");
+        w.StartObject();
+        for (size_t i = 0; i < c.values.size(); ++i) {
+            w.Key(m.env[i].first.c_str());
+            w.String(c.values[i].c_str());
+        }
+        w.EndObject();
+        w.Key("runs");
+        w.Uint(c.runs);
+        w.Key("code");
+        w.Int(c.code);
+        w.Key("wallMs");
+        w.Double(c.wallMs);
+        w.Key("wallStddevMs");
+        w.Double(c.wallStddevMs);
+        w.Key("userMs");
+        w.Double(c.userMs);
+        w.Key("systemMs");
+        w.Double(c.systemMs);
+        w.Key("cpuPercent");
+        w.Double(cpuPercent(c));
+        w.Key("maxRssKb");
+        w.Uint64(c.maxRssKb);
+        w.EndObject();
+    }
+    w.EndArray();
+
+    std::ofstream out(path);
+    if (!out) return false;
+    out << buffer.GetString() << '\n';
+    return true;
+}
+
+int runMatrix(const string& cmd) {
+    const Matrix& m = arguments.matrix;
+    std::vector<Cell> cells = buildCells(m);
+    // переменные без значений не участвуют в произведении и в таблице
+    Matrix shown = m;
+    shown.env.erase(std::remove_if(shown.env.begin(), shown.env.end(), [](auto& var) { return var.second.empty(); }),
+                    shown.env.end());
+    if (m.args.empty() && shown.env.empty()) {
+        logMessage(FAULT, "Матрица пуста: задайте matrix.args или matrix.env в конфиге");
+        return -1;
+    }
+
+    unsigned runs = std::max(1u, arguments.bench);
+    std::vector<int> cpus = runCpus();
+    unsigned parallel = std::max(1u, m.parallel);
+    if (parallel > cpus.size() && !cpus.empty()) {
+        logMessage(WARN, "Параллельных ячеек больше, чем CPU (" + std::to_string(cpus.size()) + "), будет " +
+                             std::to_string(cpus.size()));
+        parallel = static_cast<unsigned>(cpus.size());
+    }
+    parallel = std::min<unsigned>(parallel, static_cast<unsigned>(cells.size()));
+
+    logMessage(INFO, "Матрица: " + std::to_string(cells.size()) + " ячеек × " + std::to_string(runs) + " запусков, " +
+                         std::to_string(parallel) + " одновременно", true, "🧮");
+    if (parallel > 1)
+        logMessage(WARN, "Ячейки на разных CPU всё равно делят кэш и память — для точных замеров используйте -j 1",
+                   true);
+
+    // каждый поток берёт следующую ячейку и запускает её только на своей доле CPU
+    std::atomic<size_t> next{0};
+    std::mutex logLock;
+    size_t done = 0;
+    auto worker = [&](unsigned index) {
+        std::vector<int> own;
+        if (parallel > 1)
+            own.assign(cpus.begin() + index * cpus.size() / parallel,
+                       cpus.begin() + (index + 1) * cpus.size() / parallel);
+        for (size_t i; (i = next++) < cells.size();) {
+            measureCell(cmd, cells[i], runs, own);
+            std::lock_guard<std::mutex> lock(logLock);
+            string label = cells[i].args;
+            for (auto& var : cells[i].env) label += (label.empty() ? "" : " ") + var;
+            logMessageA(INFO, "    [" + std::to_string(++done) + "/" + std::to_string(cells.size()) + "] " + label +
+                                  (cells[i].ok ? " — " + fixed2(cells[i].wallMs) + " ms" : " — не запустилась"),
+                        true);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < parallel; ++i) threads.emplace_back(worker, i);
+    worker(0);
+    for (auto& t : threads) t.join();
+
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты матрицы:", true);
+    string header = "    " + string("args");
+    for (auto& var : shown.env) header += " | " + var.first;
+    logMessageA(INFO, header + " | wall, ms | user, ms | sys, ms | CPU% | RSS, MB", true);
+    int failed = 0;
+    for (auto& c : cells) {
+        string row = "    " + (c.args.empty() ? string("-") : c.args);
+        for (auto& value : c.values) row += " | " + value;
+        row += " | " + fixed2(c.wallMs);
+        if (c.runs > 1) row += " ± " + fixed2(c.wallStddevMs);
+        row += " | " + fixed2(c.userMs) + " | " + fixed2(c.systemMs) + " | " + fixed2(cpuPercent(c)) + " | " +
+               fixed2(c.maxRssKb / 1024.0);
+        if (!c.ok || c.code != 0) {
+            row += c.ok ? " | код " + std::to_string(c.code) : " | не запустилась";
+            ++failed;
+        }
+        logMessageA(INFO, row, true);
+    }
+
+    fs::path output = m.output.empty() ? fs::path(arguments.buildFolder) / (arguments.name + ".matrix.csv")
+                                       : fs::path(m.output);
+    bool json = output.extension() == ".json";
+    if (json ? writeJson(output, shown, cells) : writeCsv(output, shown, cells))
+        logMessage(INFO, "Таблица сохранена: " + output.string(), true, "💾");
+    else logMessage(WARN, "Не удалось записать " + output.string());
+
+    return failed ? 1 : 0;
+}
@@ -1,9 +1,24 @@
 #include "../monitor.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <algorithm>
 #include <thread>
 
+#include "../args.hpp"
+#include "../logger.hpp"
+
 inline static unsigned Max(unsigned a, unsigned b) { return a > b ? a : b; }
 
+static const auto SAMPLE_INTERVAL = std::chrono::milliseconds(100);
+
+static std::thread sampler;
+static std::mutex samplerMutex;
+static std::condition_variable samplerWake;
+static bool samplerStop = false;
+
 #ifdef _WIN32
 static void collectProcessStats(HANDLE hProcess, MonitoringResult& result) {
     PROCESS_MEMORY_COUNTERS pmc{};
@@ -21,18 +36,568 @@ static void collectProcessStats(HANDLE hProcess, MonitoringResult& result) {
         unsigned cpu = static_cast<unsigned>((kernelTime + userTime) / 10000000ULL);
         result.cpuMax = Max(result.cpuMax, cpu);
         result.cpuAverage = (result.cpuAverage + cpu) / 2;
+        result.cpuUserMs = userTime / 10000ULL;
+        result.cpuSystemMs = kernelTime / 10000ULL;
     }
 }
 #else
-static void collectProcessStats(pid_t pid, MonitoringResult& result) {
-    (void)pid;
-    // вставить чтение /proc/self/stat для CPU/RAM
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+
+using std::string;
+
+// private
+static string readText(const string& path) {
+    string text;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return text;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) text.append(buf, static_cast<size_t>(n));
+    close(fd);
+    return text;
+}
+
+// private: значение "key value" из файлов вида cpu.stat
+static bool readKey(const string& text, const char* key, unsigned long long& value) {
+    size_t len = strlen(key);
+    for (size_t pos = 0; pos < text.size();) {
+        if (text.compare(pos, len, key) == 0 && pos + len < text.size() && text[pos + len] == ' ') {
+            value = strtoull(text.c_str() + pos + len + 1, nullptr, 10);
+            return true;
+        }
+        pos = text.find('\n', pos);
+        if (pos == string::npos) break;
+        ++pos;
+    }
+    return false;
+}
+
+// private
+static bool writeText(const string& path, const string& text) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    return ok;
+}
+
+// ---------------- cgroup v2 ----------------
+
+// private: точка монтирования cgroup2 + собственная cgroup процесса
+static string ownCgroupDir() {
+    string mount;
+    string mountinfo = readText("/proc/self/mountinfo");
+    for (size_t pos = 0; pos < mountinfo.size();) {
+        size_t end = mountinfo.find('\n', pos);
+        if (end == string::npos) end = mountinfo.size();
+        string line = mountinfo.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t sep = line.find(" - ");
+        if (sep == string::npos || line.compare(sep + 3, 8, "cgroup2 ") != 0) continue;
+        // 36 35 0:30 / /sys/fs/cgroup rw,... - cgroup2 ...
+        size_t field = 0, start = 0;
+        for (size_t i = 0; i <= sep && field < 5; ++i) {
+            if (i == sep || line[i] == ' ') {
+                if (++field == 5) mount = line.substr(start, i - start);
+                start = i + 1;
+            }
+        }
+        if (!mount.empty()) break;
+    }
+    if (mount.empty()) return "";
+
+    string self = readText("/proc/self/cgroup");
+    size_t pos = self.find("0::");
+    if (pos == string::npos) return "";
+    size_t end = self.find('\n', pos);
+    string path = self.substr(pos + 3, end == string::npos ? string::npos : end - pos - 3);
+    if (path == "/") path.clear();
+    return mount + path;
+}
+
+string createRunCgroup() {
+    // runOnce вызывают из нескольких потоков (judge, stress)
+    static std::atomic<unsigned> counter{0};
+    string parent = ownCgroupDir();
+    if (parent.empty()) return "";
+
+    string dir = parent + "/crun-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    if (mkdir(dir.c_str(), 0755) != 0) return "";
+    return dir;
+}
+
+bool attachToCgroup(const string& cgroup, pid_t pid) {
+    return !cgroup.empty() && writeText(cgroup + "/cgroup.procs", std::to_string(pid));
+}
+
+void detachFromCgroup(const string& cgroup, pid_t pid) {
+    if (cgroup.empty()) return;
+    writeText(cgroup.substr(0, cgroup.rfind('/')) + "/cgroup.procs", std::to_string(pid));
+}
+
+void removeRunCgroup(const string& cgroup) {
+    if (cgroup.empty()) return;
+    // не удаляется, только если потомки программы ещё живы
+    if (rmdir(cgroup.c_str()) != 0 && errno != ENOENT)
+        logMessage(WARN, "Не удалось удалить cgroup (процессы ещё работают): " + cgroup);
+}
+
+bool limitRunCgroup(const string& cgroup, unsigned long long bytes) {
+    if (cgroup.empty() || !writeText(cgroup + "/memory.max", std::to_string(bytes))) return false;
+    // иначе при нехватке память уйдёт в swap, а не сработает лимит
+    writeText(cgroup + "/memory.swap.max", "0");
+    return true;
+}
+
+unsigned long long cgroupOomKills(const string& cgroup) {
+    unsigned long long kills = 0;
+    if (!cgroup.empty()) readKey(readText(cgroup + "/memory.events"), "oom_kill", kills);
+    return kills;
+}
+
+void killRunCgroup(const string& cgroup) {
+    if (cgroup.empty() || writeText(cgroup + "/cgroup.kill", "1")) return;
+    // ядра до 5.14 без cgroup.kill
+    string procs = readText(cgroup + "/cgroup.procs");
+    for (const char* p = procs.c_str(); *p;) {
+        kill(static_cast<pid_t>(atoi(p)), SIGKILL);
+        const char* end = strchr(p, '\n');
+        if (!end) break;
+        p = end + 1;
+    }
+}
+
+// ---------------- сбор статистики ----------------
+
+struct TreeSample {
+    unsigned long long cpuUs = 0;   // суммарное CPU-время
+    unsigned long long userUs = 0;  // user-время
+    unsigned long long sysUs = 0;   // system-время
+    unsigned long long ramBytes = 0;
+    unsigned long long ramPeakBytes = 0;
+    unsigned long long ioRead = 0, ioWrite = 0;  // io.stat
+    unsigned processes = 0;
+    bool ioStat = false;
+    std::vector<pid_t> pids;  // процессы дерева на момент замера
+};
+
+// private: точные суммы по всей cgroup
+static bool sampleCgroup(const string& cgroup, TreeSample& s) {
+    string cpu = readText(cgroup + "/cpu.stat");
+    if (cpu.empty() || !readKey(cpu, "usage_usec", s.cpuUs)) return false;
+    readKey(cpu, "user_usec", s.userUs);
+    readKey(cpu, "system_usec", s.sysUs);
+
+    // 8:0 rbytes=1459200 wbytes=314773504 rios=192 wios=353 dbytes=0 dios=0
+    string io = readText(cgroup + "/io.stat");
+    s.ioStat = access((cgroup + "/io.stat").c_str(), R_OK) == 0;
+    for (const char* p = io.c_str(); (p = strstr(p, "bytes=")) != nullptr; p += 6) {
+        unsigned long long v = strtoull(p + 6, nullptr, 10);
+        if (p - io.c_str() >= 1 && p[-1] == 'r') s.ioRead += v;
+        else if (p - io.c_str() >= 1 && p[-1] == 'w') s.ioWrite += v;
+    }
+
+    // без контроллера memory суммируем RSS процессов самой cgroup
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    string current = readText(cgroup + "/memory.current");
+    bool memory = !current.empty();
+    if (memory) s.ramBytes = strtoull(current.c_str(), nullptr, 10);
+    string peak = readText(cgroup + "/memory.peak");
+    if (!peak.empty()) s.ramPeakBytes = strtoull(peak.c_str(), nullptr, 10);
+
+    string procs = readText(cgroup + "/cgroup.procs");
+    for (const char* p = procs.c_str(); *p; ++p) {
+        const char* end = strchr(p, '\n');
+        if (!end) break;
+        ++s.processes;
+        s.pids.push_back(static_cast<pid_t>(atoi(p)));
+        if (!memory) {
+            string statm = readText("/proc/" + string(p, end) + "/statm");
+            const char* rss = strchr(statm.c_str(), ' ');
+            if (rss) s.ramBytes += strtoull(rss + 1, nullptr, 10) * pageSize;
+        }
+        p = end;
+    }
+    return true;
+}
+
+// private: запасной вариант — обход /proc/*/stat по PPID
+static void sampleProcTree(pid_t root, TreeSample& s) {
+    struct Proc {
+        pid_t ppid;
+        unsigned long long user, sys, rss;
+    };
+    static const long ticks = sysconf(_SC_CLK_TCK);
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+
+    std::unordered_map<pid_t, Proc> procs;
+    std::unordered_map<pid_t, std::vector<pid_t>> children;
+    DIR* dir = opendir("/proc");
+    if (!dir) return;
+    while (dirent* e = readdir(dir)) {
+        if (e->d_name[0] < '0' || e->d_name[0] > '9') continue;
+        string stat = readText(string("/proc/") + e->d_name + "/stat");
+        // comm может содержать пробелы и скобки — разбираем от последней ')'
+        size_t rp = stat.rfind(')');
+        if (rp == string::npos) continue;
+
+        char state;
+        int ppid;
+        unsigned long long utime, stime, cutime, cstime, rss;
+        if (sscanf(stat.c_str() + rp + 2,
+                   "%c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %llu %llu %*d %*d %*d %*d %*u %*u %llu",
+                   &state, &ppid, &utime, &stime, &cutime, &cstime, &rss) != 7)
+            continue;
+
+        pid_t pid = static_cast<pid_t>(atoi(e->d_name));
+        // cutime/cstime уже содержат время завершённых (и дождавшихся) потомков
+        procs[pid] = {ppid, utime + cutime, stime + cstime, rss};
+        children[ppid].push_back(pid);
+    }
+    closedir(dir);
+
+    std::vector<pid_t> queue{root};
+    while (!queue.empty()) {
+        pid_t pid = queue.back();
+        queue.pop_back();
+        auto it = procs.find(pid);
+        if (it == procs.end()) continue;
+
+        s.userUs += it->second.user * 1000000ULL / ticks;
+        s.sysUs += it->second.sys * 1000000ULL / ticks;
+        s.ramBytes += it->second.rss * pageSize;
+        ++s.processes;
+        s.pids.push_back(pid);
+
+        auto ch = children.find(pid);
+        if (ch != children.end()) queue.insert(queue.end(), ch->second.begin(), ch->second.end());
+    }
+    s.cpuUs = s.userUs + s.sysUs;
+}
+
+struct IoCounters {
+    unsigned long long rchar = 0, wchar = 0, syscr = 0, syscw = 0, readBytes = 0, writeBytes = 0;
+};
+
+// private: сумма /proc/<pid>/io; у родителя уже учтён ввод-вывод дождавшихся потомков
+static bool sampleIo(const std::vector<pid_t>& pids, IoCounters& io) {
+    bool any = false;
+    for (pid_t pid : pids) {
+        string text = readText("/proc/" + std::to_string(pid) + "/io");
+        if (text.empty()) continue;
+        IoCounters c;
+        readKey(text, "rchar:", c.rchar);
+        readKey(text, "wchar:", c.wchar);
+        readKey(text, "syscr:", c.syscr);
+        readKey(text, "syscw:", c.syscw);
+        readKey(text, "read_bytes:", c.readBytes);
+        readKey(text, "write_bytes:", c.writeBytes);
+        io.rchar += c.rchar;
+        io.wchar += c.wchar;
+        io.syscr += c.syscr;
+        io.syscw += c.syscw;
+        io.readBytes += c.readBytes;
+        io.writeBytes += c.writeBytes;
+        any = true;
+    }
+    return any;
+}
+
+// private: счётчики не должны уменьшаться, когда процесс завершился, но ещё не дождан родителем
+inline static void keepMax(unsigned long long& total, unsigned long long value) {
+    if (value > total) total = value;
+}
+
+// private: разбивка памяти процессов по smaps_rollup (и по полному smaps для heap/stack)
+static MemoryBreakdown sampleSmaps(const std::vector<pid_t>& pids, bool detailed) {
+    MemoryBreakdown m;
+    for (pid_t pid : pids) {
+        string base = "/proc/" + std::to_string(pid);
+        string rollup = readText(base + "/smaps_rollup");
+        if (rollup.empty()) continue;
+
+        unsigned long long rss = 0, pss = 0, privClean = 0, privDirty = 0, anon = 0, swap = 0;
+        readKey(rollup, "Rss:", rss);
+        readKey(rollup, "Pss:", pss);
+        readKey(rollup, "Private_Clean:", privClean);
+        readKey(rollup, "Private_Dirty:", privDirty);
+        readKey(rollup, "Anonymous:", anon);
+        readKey(rollup, "Swap:", swap);
+        m.rss += rss;
+        m.pss += pss;
+        m.uss += privClean + privDirty;
+        m.anon += anon;
+        m.file += rss > anon ? rss - anon : 0;
+        m.swap += swap;
+        m.valid = true;
+
+        if (!detailed) continue;
+        // 5581f7a2d000-5581f7a4e000 rw-p 00000000 00:00 0    [heap]
+        string smaps = readText(base + "/smaps");
+        for (const char* tag : {"[heap]", "[stack]"}) {
+            for (size_t pos = smaps.find(tag); pos != string::npos; pos = smaps.find(tag, pos + 1)) {
+                unsigned long long kb = 0;
+                size_t next = smaps.find('\n', pos);
+                if (next == string::npos || !readKey(smaps.substr(next + 1, 256), "Rss:", kb)) continue;
+                (tag[1] == 'h' ? m.heap : m.stack) += kb;
+            }
+        }
+        m.detailed = true;
+    }
+    return m;
+}
+
+// private: значение "key   :   value" из /proc/<pid>/sched; время там в миллисекундах с дробной частью
+static bool readSchedField(const string& text, const char* key, double& value) {
+    size_t len = strlen(key);
+    for (size_t pos = 0; pos < text.size();) {
+        if (text.compare(pos, len, key) == 0 && pos + len < text.size() && (text[pos + len] == ' ' || text[pos + len] == ':')) {
+            size_t colon = text.find(':', pos + len);
+            if (colon == string::npos) return false;
+            value = strtod(text.c_str() + colon + 1, nullptr);
+            return true;
+        }
+        pos = text.find('\n', pos);
+        if (pos == string::npos) break;
+        ++pos;
+    }
+    return false;
+}
+
+// private: время на CPU, в очереди и переключения потока из schedstat и sched
+static void sampleSched(const string& dir, unsigned long long startTicks, ThreadStats& t) {
+    static const long ticks = sysconf(_SC_CLK_TCK);
+    unsigned long long run, wait, slices;
+    if (sscanf(readText(dir + "schedstat").c_str(), "%llu %llu %llu", &run, &wait, &slices) != 3) return;
+
+    timespec now{};
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    unsigned long long nowNs = now.tv_sec * 1000000000ULL + now.tv_nsec, startNs = startTicks * 1000000000ULL / ticks;
+    t.runNs = run;
+    t.waitNs = wait;
+    t.timeslices = slices;
+    t.aliveNs = nowNs > startNs ? nowNs - startNs : 0;
+    t.sched = true;
+
+    string sched = readText(dir + "sched");
+    double value;
+    if (readSchedField(sched, "se.nr_migrations", value)) t.migrations = static_cast<unsigned long long>(value);
+    if (readSchedField(sched, "nr_voluntary_switches", value)) t.voluntarySwitches = static_cast<unsigned long long>(value);
+    if (readSchedField(sched, "nr_involuntary_switches", value))
+        t.involuntarySwitches = static_cast<unsigned long long>(value);
+    // поле есть только при включённых schedstats, имя зависит от версии ядра
+    if (readSchedField(sched, "sum_block_runtime", value) ||
+        readSchedField(sched, "se.statistics.sum_block_runtime", value))
+        t.blockNs = static_cast<unsigned long long>(value * 1e6);
+}
+
+// private: CPU-время каждого потока из /proc/<pid>/task/*/stat, возвращает число живых потоков
+static unsigned sampleThreads(const std::vector<pid_t>& pids, std::unordered_map<pid_t, ThreadStats>& threads) {
+    static const long ticks = sysconf(_SC_CLK_TCK);
+    unsigned count = 0;
+    for (pid_t pid : pids) {
+        string task = "/proc/" + std::to_string(pid) + "/task/";
+        DIR* dir = opendir(task.c_str());
+        if (!dir) continue;
+        while (dirent* e = readdir(dir)) {
+            if (e->d_name[0] < '0' || e->d_name[0] > '9') continue;
+            string stat = readText(task + e->d_name + "/stat");
+            size_t lp = stat.find('('), rp = stat.rfind(')');
+            if (lp == string::npos || rp == string::npos || rp < lp) continue;
+
+            unsigned long long utime, stime, start;
+            if (sscanf(stat.c_str() + rp + 2,
+                       "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %llu", &utime,
+                       &stime, &start) != 3)
+                continue;
+
+            pid_t tid = static_cast<pid_t>(atoi(e->d_name));
+            ThreadStats& t = threads[tid];
+            t.tid = tid;
+            t.pid = pid;
+            t.name = stat.substr(lp + 1, rp - lp - 1);
+            t.cpuMs = (utime + stime) * 1000 / ticks;
+            sampleSched(task + e->d_name + "/", start, t);
+            ++count;
+        }
+        closedir(dir);
+    }
+    return count;
+}
+
+int reapProcess(pid_t pid, MonitoringResult* result) {
+    // итоги дождавшихся потомков добавляются к счётчикам родителя, то есть crun
+    IoCounters before, after;
+    if (result) sampleIo({getpid()}, before);
+
+    int status = 0;
+    struct rusage usage {};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+    if (!result) return status;
+
+    // без cgroup точные суммы CPU даёт rusage (вместе с дождавшимися потомками)
+    if (!result->cgroup) {
+        result->cpuUserMs = usage.ru_utime.tv_sec * 1000ULL + usage.ru_utime.tv_usec / 1000;
+        result->cpuSystemMs = usage.ru_stime.tv_sec * 1000ULL + usage.ru_stime.tv_usec / 1000;
+    }
+    result->ramMax = Max(result->ramMax, static_cast<unsigned>(usage.ru_maxrss / 1024));
+
+    // после выхода /proc/<pid>/io уже не читается — последний всплеск виден только так
+    if (sampleIo({getpid()}, after)) {
+        result->io = true;
+        keepMax(result->ioReadChars, after.rchar - before.rchar);
+        keepMax(result->ioWriteChars, after.wchar - before.wchar);
+        keepMax(result->ioReadCalls, after.syscr - before.syscr);
+        keepMax(result->ioWriteCalls, after.syscw - before.syscw);
+        keepMax(result->ioReadBytes, after.readBytes - before.readBytes);
+        keepMax(result->ioWriteBytes, after.writeBytes - before.writeBytes);
+    }
+    return status;
+}
+
+void monitorProcess(pid_t pid, MonitoringResult& result, const string& cgroup) {
+    result = {};
+    samplerStop = false;
+    sampler = std::thread([pid, &result, cgroup]() {
+        auto started = std::chrono::steady_clock::now(), last = started;
+        unsigned long long lastCpuUs = 0, ramSumMB = 0, samples = 0, threadSum = 0, peakSnapshotBytes = 0;
+        bool useCgroup = !cgroup.empty();
+        std::unordered_map<pid_t, ThreadStats> threads;
+
+        while (true) {
+            std::unique_lock<std::mutex> lock(samplerMutex);
+            bool stop = samplerWake.wait_for(lock, SAMPLE_INTERVAL, [] { return samplerStop; });
+            lock.unlock();
+
+            TreeSample s;
+            if (useCgroup && !sampleCgroup(cgroup, s)) useCgroup = false;
+            if (!useCgroup) sampleProcTree(pid, s);
+
+            auto now = std::chrono::steady_clock::now();
+            auto wallUs = std::chrono::duration_cast<std::chrono::microseconds>(now - last).count();
+            last = now;
+
+            if (wallUs > 0 && s.cpuUs >= lastCpuUs) {
+                unsigned cpu = static_cast<unsigned>((s.cpuUs - lastCpuUs) * 100 / wallUs);
+                result.cpuMax = Max(result.cpuMax, cpu);
+            }
+            lastCpuUs = s.cpuUs;
+            auto totalUs = std::chrono::duration_cast<std::chrono::microseconds>(now - started).count();
+            if (totalUs > 0) result.cpuAverage = static_cast<unsigned>(s.cpuUs * 100 / totalUs);
+
+            unsigned ramMB = static_cast<unsigned>(s.ramBytes / 1024 / 1024);
+            // после завершения процесса RSS уже нулевой — в среднее его не берём
+            if (!stop || samples == 0) {
+                ramSumMB += ramMB;
+                ++samples;
+            }
+            result.ramMax = Max(result.ramMax, Max(ramMB, static_cast<unsigned>(s.ramPeakBytes / 1024 / 1024)));
+
+            // smaps дорог — снимаем только на новом пике (с шагом не меньше 1 MB)
+            if (!stop && (peakSnapshotBytes == 0 || s.ramBytes >= peakSnapshotBytes + 1024 * 1024)) {
+                MemoryBreakdown m = sampleSmaps(s.pids, arguments.smaps);
+                if (m.valid) {
+                    result.peakMemory = m;
+                    peakSnapshotBytes = s.ramBytes;
+                }
+            }
+            result.ramAverage = static_cast<unsigned>(ramSumMB / samples);
+            result.processesMax = Max(result.processesMax, s.processes);
+
+            if (s.cpuUs > 0) {
+                result.cpuUserMs = s.userUs / 1000;
+                result.cpuSystemMs = s.sysUs / 1000;
+            }
+            result.cgroup = useCgroup;
+
+            IoCounters io;
+            if (sampleIo(s.pids, io)) {
+                result.io = true;
+                if (wallUs > 0) {
+                    double seconds = wallUs / 1e6;
+                    if (io.rchar > result.ioReadChars)
+                        result.ioReadPeakMBs = std::max(result.ioReadPeakMBs,
+                                                        (io.rchar - result.ioReadChars) / 1048576.0 / seconds);
+                    if (io.wchar > result.ioWriteChars)
+                        result.ioWritePeakMBs = std::max(result.ioWritePeakMBs,
+                                                         (io.wchar - result.ioWriteChars) / 1048576.0 / seconds);
+                    unsigned long long calls = io.syscr + io.syscw, lastCalls = result.ioReadCalls + result.ioWriteCalls;
+                    if (calls > lastCalls)
+                        result.ioCallsPeak = std::max(result.ioCallsPeak,
+                                                      static_cast<unsigned long long>((calls - lastCalls) / seconds));
+                }
+                keepMax(result.ioReadChars, io.rchar);
+                keepMax(result.ioWriteChars, io.wchar);
+                keepMax(result.ioReadCalls, io.syscr);
+                keepMax(result.ioWriteCalls, io.syscw);
+                if (!s.ioStat) {
+                    keepMax(result.ioReadBytes, io.readBytes);
+                    keepMax(result.ioWriteBytes, io.writeBytes);
+                }
+            }
+            if (s.ioStat) {
+                result.ioReadBytes = s.ioRead;
+                result.ioWriteBytes = s.ioWrite;
+            }
+
+            // потоки завершённого процесса уже не видны — сохраняем последние значения
+            unsigned threadCount = sampleThreads(s.pids, threads);
+            if (!stop || result.threadTimeline.empty()) {
+                result.threadTimeline.push_back(threadCount);
+                threadSum += threadCount;
+                result.threadsMax = Max(result.threadsMax, threadCount);
+                result.threadsAverage = static_cast<unsigned>(threadSum / result.threadTimeline.size());
+            }
+
+            if (stop || kill(pid, 0) != 0) break;
+        }
+
+        // суммы копит ядро, у каждого потока берём последние снятые значения
+        SchedStats& sched = result.sched;
+        unsigned long long blockNs = 0, offNs = 0;
+        for (auto& entry : threads) {
+            const ThreadStats& t = entry.second;
+            if (!t.sched) continue;
+            sched.valid = true;
+            sched.runMs += t.runNs / 1000000;
+            sched.waitMs += t.waitNs / 1000000;
+            if (t.aliveNs > t.runNs + t.waitNs) offNs += t.aliveNs - t.runNs - t.waitNs;
+            blockNs += t.blockNs;
+            if (t.blockNs) sched.blockKnown = true;
+            sched.timeslices += t.timeslices;
+            sched.migrations += t.migrations;
+            sched.voluntarySwitches += t.voluntarySwitches;
+            sched.involuntarySwitches += t.involuntarySwitches;
+        }
+        sched.offCpuMs = offNs / 1000000;
+        sched.blockMs = std::min(blockNs, offNs) / 1000000;
+
+        result.threads.reserve(threads.size());
+        for (auto& t : threads) result.threads.push_back(std::move(t.second));
+        std::sort(result.threads.begin(), result.threads.end(),
+                  [](const ThreadStats& a, const ThreadStats& b) { return a.cpuMs > b.cpuMs; });
+    });
 }
 #endif
 
 #ifdef _WIN32
-void monitorProcess(DWORD pid, MonitoringResult& result) {
-    std::thread([pid, &result]() {
+void monitorProcess(DWORD pid, MonitoringResult& result, const std::string&) {
+    result = {};
+    samplerStop = false;
+    sampler = std::thread([pid, &result]() {
         HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
         if (!hProcess) return;
 
@@ -42,28 +607,20 @@ void monitorProcess(DWORD pid, MonitoringResult& result) {
             DWORD code = 0;
             if (!GetExitCodeProcess(hProcess, &code) || code != STILL_ACTIVE) break;
 
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::unique_lock<std::mutex> lock(samplerMutex);
+            if (samplerWake.wait_for(lock, SAMPLE_INTERVAL, [] { return samplerStop; })) break;
         }
 
         CloseHandle(hProcess);
-    }).detach();
+    });
 }
-#else
-void monitorProcess(pid_t pid, MonitoringResult& result) {
-    result = {};
-    return;
-    std::thread([pid, &result]() {
-        MonitoringResult result{};
-        while (true) {
-            collectProcessStats(pid, result);
-
-            // проверка завершения процесса на Linux (через kill(pid, 0))
-            if (kill(pid, 0) != 0) break;
-
-            if (callback) callback(result);
+#endif
 
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-    }).detach();
+void shutdownMonitor() {
+    {
+        std::lock_guard<std::mutex> lock(samplerMutex);
+        samplerStop = true;
+    }
+    samplerWake.notify_all();
+    if (sampler.joinable()) sampler.join();
 }
-#endif
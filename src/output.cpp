@@ -0,0 +1,187 @@
+#include "../output.hpp"
+
+#include <vector>
+
+static const size_t CHUNK = 1 << 20;
+
+void printFile(const std::string& path, FILE* stream) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return;
+    std::vector<char> buf(CHUNK);
+    size_t n;
+    while ((n = fread(buf.data(), 1, buf.size(), f)) > 0) fwrite(buf.data(), 1, n, stream);
+    fclose(f);
+    fflush(stream);
+}
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+// больше 1 MB обычный пользователь не поставит без правки /proc/sys/fs/pipe-max-size
+static const int PIPE_SIZES[] = {1 << 20, 256 << 10, 64 << 10};
+// сколько хранить в tail до обрезки: обрезаем редко, чтобы не двигать память на каждом чтении
+static const size_t TAIL_SLACK = 4 << 20;
+
+static int readFd = -1, writeFd = -1, fileFd = -1;
+static std::thread reader;
+static OutputStats captured;
+
+// private
+static unsigned long long countLines(const char* data, size_t size) {
+    unsigned long long lines = 0;
+    for (const char* p = data; (p = static_cast<const char*>(memchr(p, '\n', data + size - p))); ++p) ++lines;
+    return lines;
+}
+
+// private: оставляет в text последние n строк (незавершённая последняя строка тоже считается)
+static void keepLastLines(string& text, unsigned n) {
+    size_t pos = text.size();
+    if (pos && text[pos - 1] == '\n') --pos;
+    for (unsigned count = 0; pos > 0;) {
+        size_t nl = text.rfind('\n', pos - 1);
+        if (nl == string::npos) break;
+        if (++count == n) {
+            text.erase(0, nl + 1);
+            break;
+        }
+        pos = nl;
+    }
+    // строки без переводов не должны съесть всю память
+    if (text.size() > TAIL_SLACK) text.erase(0, text.size() - TAIL_SLACK);
+}
+
+// private
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// private: file — pipe → файл через splice без копирования в user space; строки считаются потом
+static void spliceToFile() {
+    for (;;) {
+        ssize_t n = splice(readFd, nullptr, fileFd, nullptr, CHUNK, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n > 0) {
+            captured.bytes += static_cast<unsigned long long>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0) return;
+        break;
+    }
+    // файловая система без splice: дочитываем обычным способом
+    std::vector<char> buf(CHUNK);
+    for (;;) {
+        ssize_t n = read(readFd, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        writeAll(fileFd, buf.data(), static_cast<size_t>(n));
+        captured.bytes += static_cast<unsigned long long>(n);
+    }
+}
+
+// private: discard, tail и tee — чтение большими кусками
+static void readChunks() {
+    const string& mode = arguments.stdoutMode;
+    std::vector<char> buf(CHUNK);
+    for (;;) {
+        ssize_t n = read(readFd, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        size_t size = static_cast<size_t>(n);
+        captured.bytes += size;
+        captured.lines += countLines(buf.data(), size);
+        if (mode == "tail") {
+            captured.tail.append(buf.data(), size);
+            if (captured.tail.size() > TAIL_SLACK) keepLastLines(captured.tail, arguments.stdoutTail);
+        }
+        else if (mode == "tee") {
+            writeAll(STDOUT_FILENO, buf.data(), size);
+            writeAll(fileFd, buf.data(), size);
+        }
+    }
+    if (mode == "tail") keepLastLines(captured.tail, arguments.stdoutTail);
+}
+
+int openOutputCapture() {
+    const string& mode = arguments.stdoutMode;
+    if (mode.empty()) return -1;
+    if (mode != "discard" && mode != "file" && mode != "tail" && mode != "tee") {
+        logMessage(WARN, "Неизвестный режим -stdout: " + mode + " (нужно discard|file|tail|tee)");
+        return -1;
+    }
+    captured = OutputStats{};
+
+    if (mode == "file" || mode == "tee") {
+        captured.file = arguments.stdoutFile.empty()
+                            ? (fs::path(arguments.buildFolder) / (arguments.name + ".stdout")).string()
+                            : arguments.stdoutFile;
+        fileFd = open(captured.file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fileFd < 0) {
+            logMessage(WARN, "Не удалось открыть " + captured.file + ": " + strerror(errno));
+            return -1;
+        }
+    }
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        logMessage(WARN, string("Не удалось создать pipe для stdout: ") + strerror(errno));
+        if (fileFd >= 0) close(fileFd);
+        fileFd = -1;
+        return -1;
+    }
+    readFd = fds[0];
+    writeFd = fds[1];
+    // с буфером по умолчанию (64 KB) программа чаще блокируется на записи, ожидая приёмник
+    for (int size : PIPE_SIZES)
+        if (fcntl(writeFd, F_SETPIPE_SZ, size) >= 0) break;
+    return writeFd;
+}
+
+void startOutputCapture() {
+    if (writeFd < 0) return;
+    // иначе EOF не придёт: у нас остался бы свой писатель
+    close(writeFd);
+    writeFd = -1;
+    reader = std::thread(arguments.stdoutMode == "file" ? spliceToFile : readChunks);
+}
+
+void finishOutputCapture(OutputStats& stats) {
+    if (reader.joinable()) reader.join();
+    if (readFd >= 0) close(readFd);
+    if (writeFd >= 0) close(writeFd);
+    readFd = writeFd = -1;
+
+    // строки файла считаем уже после замера, чтобы не тормозить приём
+    if (fileFd >= 0 && arguments.stdoutMode == "file") {
+        std::vector<char> buf(CHUNK);
+        ssize_t n;
+        off_t offset = 0;
+        while ((n = pread(fileFd, buf.data(), buf.size(), offset)) > 0) {
+            captured.lines += countLines(buf.data(), static_cast<size_t>(n));
+            offset += n;
+        }
+    }
+    if (fileFd >= 0) close(fileFd);
+    fileFd = -1;
+    stats = std::move(captured);
+    captured = OutputStats{};
+}
+#endif
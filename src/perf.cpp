@@ -0,0 +1,269 @@
+#include "../perf.hpp"
+
+#ifndef _WIN32
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../logger.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+// Сырые счётчики top-down: у каждой группы свой знаменатель slots
+struct TopDownRaw {
+    // Intel до Ice Lake: topdown-* из sysfs, две группы
+    PerfCounter slotsA, issued, retired;
+    PerfCounter slotsB, fetchBubbles, recoveryBubbles;
+    // Ice Lake и новее: slots + perf metrics, одна группа
+    PerfCounter slots, metricRetiring, metricBadSpec, metricFeBound, metricBeBound;
+};
+
+struct OpenCounter {
+    int fd;
+    PerfCounter* target;
+    double scale;  // *.scale из sysfs
+};
+
+struct EventSpec {
+    uint64_t config;
+    PerfCounter* target;
+    double scale = 1;
+};
+
+static std::vector<OpenCounter> counters;
+static PerfResult collected;
+static TopDownRaw topDownRaw;
+static bool userOnly = false;
+
+// private
+static int perfEventOpen(perf_event_attr& attr, pid_t pid, int groupFd) {
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+// private
+static int paranoidLevel() {
+    int level = 2;
+    std::ifstream("/proc/sys/kernel/perf_event_paranoid") >> level;
+    return level;
+}
+
+// private: одна группа планируется на PMU целиком, поэтому отношения внутри неё точные;
+// complete — группа нужна только целиком (top-down), иначе пропускаем неоткрывшиеся события
+static bool openGroup(pid_t pid, uint32_t type, const std::vector<EventSpec>& events, bool complete = false) {
+    int leader = -1;
+    size_t first = counters.size();
+    for (auto& event : events) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = event.config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;  // считаем и потомков /bin/sh
+        attr.disabled = leader < 0;
+        attr.enable_on_exec = leader < 0;
+        attr.exclude_kernel = userOnly;
+        attr.exclude_hv = userOnly;
+
+        int fd = perfEventOpen(attr, pid, leader);
+        if (fd < 0 && (errno == EACCES || errno == EPERM) && !userOnly) {
+            // perf_event_paranoid >= 2: без CAP_PERFMON разрешено только user-space
+            userOnly = true;
+            attr.exclude_kernel = attr.exclude_hv = 1;
+            fd = perfEventOpen(attr, pid, leader);
+        }
+        if (fd < 0) {
+            if (!complete) continue;
+            for (size_t i = first; i < counters.size(); ++i) close(counters[i].fd);
+            counters.resize(first);
+            return false;
+        }
+
+        if (leader < 0) leader = fd;
+        counters.push_back({fd, event.target, event.scale});
+    }
+    return leader >= 0;
+}
+
+// ---------------- события из sysfs ----------------
+
+// private: PMU ядер CPU; у гибридных Intel это cpu_core
+static string corePmu() {
+    for (const char* name : {"/sys/bus/event_source/devices/cpu_core", "/sys/bus/event_source/devices/cpu"})
+        if (fs::exists(string(name) + "/type")) return name;
+    return "";
+}
+
+// private: "event=0x3c,umask=0x0,any=1" → config по описаниям format/*
+static bool sysfsEvent(const string& pmu, const string& name, uint64_t& config, double& scale) {
+    std::ifstream f(pmu + "/events/" + name);
+    string spec;
+    if (!std::getline(f, spec)) return false;
+
+    config = 0;
+    std::stringstream terms(spec);
+    string term;
+    while (std::getline(terms, term, ',')) {
+        size_t eq = term.find('=');
+        string key = term.substr(0, eq);
+        uint64_t value = eq == string::npos ? 1 : strtoull(term.c_str() + eq + 1, nullptr, 0);
+
+        // config:0-7,21  — биты значения раскладываются по диапазонам по порядку
+        std::ifstream ff(pmu + "/format/" + key);
+        string format;
+        if (!std::getline(ff, format) || format.compare(0, 7, "config:") != 0) return false;
+        std::stringstream ranges(format.substr(7));
+        string range;
+        unsigned shift = 0;
+        while (std::getline(ranges, range, ',')) {
+            unsigned lo = static_cast<unsigned>(atoi(range.c_str())), hi = lo;
+            size_t dash = range.find('-');
+            if (dash != string::npos) hi = static_cast<unsigned>(atoi(range.c_str() + dash + 1));
+            for (unsigned bit = lo; bit <= hi; ++bit, ++shift)
+                if ((value >> shift) & 1) config |= 1ULL << bit;
+        }
+    }
+
+    scale = 1;
+    std::ifstream scaleFile(pmu + "/events/" + name + ".scale");
+    scaleFile >> scale;
+    return true;
+}
+
+// private: группы для TMA уровня 1
+static bool openTopDown(pid_t pid) {
+    string pmu = corePmu();
+    if (pmu.empty()) return false;
+    uint32_t type = 0;
+    std::ifstream(pmu + "/type") >> type;
+
+    auto spec = [&](const char* name, PerfCounter& target, EventSpec& out) {
+        out.target = &target;
+        return sysfsEvent(pmu, name, out.config, out.scale);
+    };
+
+    // Ice Lake+: slots обязан быть лидером, метрики ядро отдаёт уже в слотах
+    std::vector<EventSpec> metrics(5);
+    if (spec("slots", topDownRaw.slots, metrics[0]) && spec("topdown-retiring", topDownRaw.metricRetiring, metrics[1]) &&
+        spec("topdown-bad-spec", topDownRaw.metricBadSpec, metrics[2]) &&
+        spec("topdown-fe-bound", topDownRaw.metricFeBound, metrics[3]) &&
+        spec("topdown-be-bound", topDownRaw.metricBeBound, metrics[4]) && openGroup(pid, type, metrics, true))
+        return true;
+
+    // до Ice Lake пять событий не помещаются в 4 счётчика при SMT — две группы со своим slots,
+    // ядро мультиплексирует их, а доли считаются внутри группы
+    std::vector<EventSpec> retire(3), bubbles(3);
+    if (!spec("topdown-total-slots", topDownRaw.slotsA, retire[0]) ||
+        !spec("topdown-slots-issued", topDownRaw.issued, retire[1]) ||
+        !spec("topdown-slots-retired", topDownRaw.retired, retire[2]) ||
+        !spec("topdown-total-slots", topDownRaw.slotsB, bubbles[0]) ||
+        !spec("topdown-fetch-bubbles", topDownRaw.fetchBubbles, bubbles[1]) ||
+        !spec("topdown-recovery-bubbles", topDownRaw.recoveryBubbles, bubbles[2]))
+        return false;
+    if (!openGroup(pid, type, retire, true)) return false;
+    return openGroup(pid, type, bubbles, true);
+}
+
+// private
+static TopDown computeTopDown(const TopDownRaw& raw) {
+    TopDown td;
+    auto minRunning = [](std::initializer_list<const PerfCounter*> list) {
+        double running = 1;
+        for (auto* c : list) {
+            if (!c->ok) return 0.0;
+            if (c->running < running) running = c->running;
+        }
+        return running;
+    };
+
+    if (raw.slots.ok && raw.slots.value) {
+        double slots = static_cast<double>(raw.slots.value);
+        td.retiring = raw.metricRetiring.value / slots;
+        td.badSpeculation = raw.metricBadSpec.value / slots;
+        td.frontendBound = raw.metricFeBound.value / slots;
+        td.backendBound = raw.metricBeBound.value / slots;
+        td.running = minRunning({&raw.slots, &raw.metricRetiring, &raw.metricBadSpec, &raw.metricFeBound,
+                                 &raw.metricBeBound});
+        td.ok = td.running > 0;
+        return td;
+    }
+
+    if (!raw.slotsA.ok || !raw.slotsB.ok || !raw.slotsA.value || !raw.slotsB.value) return td;
+    double slotsA = static_cast<double>(raw.slotsA.value), slotsB = static_cast<double>(raw.slotsB.value);
+    td.retiring = raw.retired.value / slotsA;
+    double wasted = raw.issued.value > raw.retired.value ? (raw.issued.value - raw.retired.value) / slotsA : 0;
+    td.badSpeculation = wasted + raw.recoveryBubbles.value / slotsB;
+    td.frontendBound = raw.fetchBubbles.value / slotsB;
+    td.backendBound = 1 - td.retiring - td.badSpeculation - td.frontendBound;
+    if (td.backendBound < 0) td.backendBound = 0;
+    td.running = minRunning({&raw.slotsA, &raw.issued, &raw.retired, &raw.slotsB, &raw.fetchBubbles,
+                             &raw.recoveryBubbles});
+    td.ok = td.running > 0;
+    return td;
+}
+
+bool openPerfCounters(pid_t pid, bool general, bool topDown) {
+    counters.clear();
+    collected = {};
+    topDownRaw = {};
+    userOnly = false;
+
+    bool hardware = false, software = false, tma = false;
+    if (general) {
+        hardware = openGroup(pid, PERF_TYPE_HARDWARE,
+                             {{PERF_COUNT_HW_CPU_CYCLES, &collected.cycles},
+                              {PERF_COUNT_HW_INSTRUCTIONS, &collected.instructions},
+                              {PERF_COUNT_HW_BRANCH_INSTRUCTIONS, &collected.branches},
+                              {PERF_COUNT_HW_BRANCH_MISSES, &collected.branchMisses}});
+        // кэш — отдельной группой: на части CPU все шесть событий не помещаются в счётчики
+        hardware |= openGroup(pid, PERF_TYPE_HARDWARE,
+                              {{PERF_COUNT_HW_CACHE_REFERENCES, &collected.cacheReferences},
+                               {PERF_COUNT_HW_CACHE_MISSES, &collected.cacheMisses}});
+        software = openGroup(pid, PERF_TYPE_SOFTWARE,
+                             {{PERF_COUNT_SW_TASK_CLOCK, &collected.taskClock},
+                              {PERF_COUNT_SW_PAGE_FAULTS, &collected.pageFaults}});
+
+        if (!hardware)
+            logMessage(WARN, "Аппаратные счётчики недоступны (perf_event_paranoid = " + std::to_string(paranoidLevel()) +
+                                 " или нет PMU), только программные", true);
+        if (!software) logMessage(WARN, "perf_event_open недоступен, счётчики отключены", true);
+    }
+    if (topDown) {
+        tma = openTopDown(pid);
+        if (!tma) logMessage(WARN, "Top-down недоступен: CPU не экспортирует события topdown-* в sysfs", true);
+    }
+    return hardware || software || tma;
+}
+
+void readPerfCounters(PerfResult& result) {
+    for (auto& c : counters) {
+        struct {
+            uint64_t value, enabled, running;
+        } data{};
+        if (read(c.fd, &data, sizeof(data)) == sizeof(data) && data.running > 0) {
+            PerfCounter& counter = *c.target;
+            counter.running = static_cast<double>(data.running) / data.enabled;
+            counter.value = static_cast<unsigned long long>(data.value / counter.running * c.scale);
+            counter.ok = true;
+        }
+        close(c.fd);
+    }
+    counters.clear();
+
+    result = collected;
+    result.hardware = result.cycles.ok || result.instructions.ok || result.branches.ok || result.cacheReferences.ok;
+    result.software = result.taskClock.ok || result.pageFaults.ok;
+    result.userOnly = userOnly;
+    result.topDown = computeTopDown(topDownRaw);
+}
+#endif
@@ -0,0 +1,857 @@
+#include "../preload.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../profiler.hpp"
+#include "../runner.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+static const unsigned HEAP_RATE = 64;     // backtrace снимается у каждой 64-й мелкой аллокации
+static const size_t SITE_FRAMES = 6;      // кадров в отчёте о месте выделения
+static string heapPrefix, lockPrefix;     // <build>/<name>.heap|.locks, процессы дописывают .<pid>
+
+// Интерпозер собирается из исходника на машине пользователя, поэтому всегда совпадает с его glibc.
+// Аллокатор не подменяется: вызовы уходят в __libc_*, а вокруг считаются вызовы и байты.
+static const char* HEAP_SOURCE = R"CRUN(// crun: счётчик аллокаций, подгружается через LD_PRELOAD
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+void* __libc_memalign(size_t, size_t);
+void* __libc_valloc(size_t);
+void* __libc_pvalloc(size_t);
+}
+
+namespace {
+enum Kind { MALLOC, REALLOC, FREE, NEW, DELETE, KINDS };
+
+const int DEPTH = 24;
+const int SKIP = 2;  // record() и сама обёртка
+const unsigned TABLE = 4096;
+const size_t LARGE = 64 * 1024;
+
+struct Site {
+    unsigned long long hash;
+    unsigned long long calls, bytes;
+    int depth;
+    void* frames[DEPTH];
+};
+
+std::atomic<unsigned long long> calls[KINDS];
+std::atomic<unsigned long long> total{0}, sequence{0}, dropped{0};
+std::atomic<long long> live{0}, peak{0};
+std::atomic_flag lock = ATOMIC_FLAG_INIT;
+Site sites[TABLE];
+unsigned rate = 64;
+char output[4096];
+
+// backtrace и dladdr сами могут выделять память — такие вызовы считаем, но не сэмплируем
+__thread bool busy __attribute__((tls_model("initial-exec")));
+
+void grow(long long bytes) {
+    long long now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    long long top = peak.load(std::memory_order_relaxed);
+    while (now > top && !peak.compare_exchange_weak(top, now, std::memory_order_relaxed)) {}
+}
+
+__attribute__((noinline)) void record(Kind kind, size_t size, void* p) {
+    calls[kind].fetch_add(1, std::memory_order_relaxed);
+    if (!p) return;
+    total.fetch_add(size, std::memory_order_relaxed);
+    grow(static_cast<long long>(malloc_usable_size(p)));
+    // крупные блоки пишем всегда, мелкие — каждый rate-й с весом rate
+    unsigned long long weight = size >= LARGE ? 1 : rate;
+    if (busy || (weight > 1 && sequence.fetch_add(1, std::memory_order_relaxed) % rate != 0)) return;
+
+    busy = true;
+    void* frames[DEPTH + SKIP];
+    int depth = backtrace(frames, DEPTH + SKIP) - SKIP;
+    if (depth > 0) {
+        unsigned long long hash = 1469598103934665603ULL;
+        for (int i = 0; i < depth; ++i)
+            hash = (hash ^ reinterpret_cast<unsigned long long>(frames[SKIP + i])) * 1099511628211ULL;
+        hash |= 1;  // 0 — свободная ячейка
+
+        while (lock.test_and_set(std::memory_order_acquire)) {}
+        unsigned i = static_cast<unsigned>(hash % TABLE), probes = 0;
+        while (sites[i].hash && sites[i].hash != hash && ++probes < TABLE) i = (i + 1) % TABLE;
+        if (probes < TABLE) {
+            Site& s = sites[i];
+            if (!s.hash) {
+                s.hash = hash;
+                s.depth = depth;
+                memcpy(s.frames, frames + SKIP, depth * sizeof(void*));
+            }
+            s.calls += weight;
+            s.bytes += size * weight;
+        }
+        else dropped.fetch_add(1, std::memory_order_relaxed);
+        lock.clear(std::memory_order_release);
+    }
+    busy = false;
+}
+
+void release(Kind kind, void* p) {
+    calls[kind].fetch_add(1, std::memory_order_relaxed);
+    if (p) live.fetch_sub(static_cast<long long>(malloc_usable_size(p)), std::memory_order_relaxed);
+}
+
+// alignment — для new с std::align_val_t; 0 — обычное выравнивание malloc
+void* allocate(size_t size, bool nothrow, size_t alignment = 0) {
+    void* p;
+    while (!(p = alignment ? __libc_memalign(alignment, size ? size : 1) : __libc_malloc(size ? size : 1))) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow) return nullptr;
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+    record(NEW, size, p);
+    return p;
+}
+
+// после fork ребёнок начинает счёт заново, иначе отчёт родителя учтётся дважды
+void resetChild() {
+    for (auto& c : calls) c.store(0);
+    total.store(0);
+    live.store(0);
+    peak.store(0);
+    memset(sites, 0, sizeof(sites));
+    lock.clear();
+}
+
+void put(int fd, const char* text) {
+    size_t left = strlen(text);
+    while (left > 0) {
+        ssize_t n = write(fd, text, left);
+        if (n <= 0) return;
+        text += n;
+        left -= n;
+    }
+}
+
+__attribute__((constructor)) void start() {
+    const char* out = getenv("CRUN_HEAP_OUT");
+    if (out) snprintf(output, sizeof(output), "%s", out);
+    const char* r = getenv("CRUN_HEAP_RATE");
+    if (r && atoi(r) > 0) rate = atoi(r);
+    // первый backtrace подгружает libgcc_s — делаем это заранее, вне аллокаций программы
+    busy = true;
+    void* frame;
+    backtrace(&frame, 1);
+    busy = false;
+    pthread_atfork(nullptr, nullptr, resetChild);
+}
+
+__attribute__((destructor)) void finish() {
+    if (!output[0]) return;
+    busy = true;
+    char path[4200], line[4600], exe[4096];
+    snprintf(path, sizeof(path), "%s.%d", output, static_cast<int>(getpid()));
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    exe[n > 0 ? n : 0] = 0;
+
+    long long left = live.load();
+    snprintf(line, sizeof(line), "malloc %llu\nrealloc %llu\nfree %llu\nnew %llu\ndelete %llu\nbytes %llu\n"
+             "live %lld\npeak %lld\nrate %u\ndropped %llu\n", calls[MALLOC].load(), calls[REALLOC].load(),
+             calls[FREE].load(), calls[NEW].load(), calls[DELETE].load(), total.load(), left > 0 ? left : 0,
+             peak.load(), rate, dropped.load());
+    put(fd, line);
+
+    // адрес возврата указывает за call, -1 попадает внутрь вызывающей функции
+    for (auto& s : sites) {
+        if (!s.hash) continue;
+        snprintf(line, sizeof(line), "site\t%llu\t%llu", s.calls, s.bytes);
+        put(fd, line);
+        for (int i = 0; i < s.depth; ++i) {
+            Dl_info info;
+            if (!dladdr(static_cast<char*>(s.frames[i]) - 1, &info) || !info.dli_fbase) continue;
+            const char* module = info.dli_fname && info.dli_fname[0] == '/' ? info.dli_fname : exe;
+            snprintf(line, sizeof(line), "\t0x%lx %s",
+                     static_cast<unsigned long>(static_cast<char*>(s.frames[i]) - 1 - static_cast<char*>(info.dli_fbase)),
+                     module);
+            put(fd, line);
+        }
+        put(fd, "\n");
+    }
+    close(fd);
+}
+}  // namespace
+
+extern "C" {
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    record(MALLOC, size, p);
+    return p;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* p = __libc_calloc(count, size);
+    record(MALLOC, count * size, p);
+    return p;
+}
+
+void* realloc(void* old, size_t size) {
+    if (!old) return malloc(size);
+    size_t before = malloc_usable_size(old);
+    void* p = __libc_realloc(old, size);
+    if (size == 0 || p) live.fetch_sub(static_cast<long long>(before), std::memory_order_relaxed);
+    record(REALLOC, size, p);
+    return p;
+}
+
+void* reallocarray(void* old, size_t count, size_t size) {
+    if (size && count > static_cast<size_t>(-1) / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(old, count * size);
+}
+
+void free(void* p) {
+    if (!p) return;
+    release(FREE, p);
+    __libc_free(p);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    record(MALLOC, size, p);
+    return p;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    record(MALLOC, size, p);
+    return p;
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* p = __libc_memalign(alignment, size);
+    record(MALLOC, size, p);
+    if (!p) return ENOMEM;
+    *result = p;
+    return 0;
+}
+
+void* valloc(size_t size) {
+    void* p = __libc_valloc(size);
+    record(MALLOC, size, p);
+    return p;
+}
+
+void* pvalloc(size_t size) {
+    void* p = __libc_pvalloc(size);
+    record(MALLOC, size, p);
+    return p;
+}
+}
+
+void* operator new(size_t size) { return allocate(size, false); }
+void* operator new[](size_t size) { return allocate(size, false); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size, true); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size, true); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    release(DELETE, p);
+    __libc_free(p);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+
+// перевыровненные типы (alignas больше 16) — тоже new/delete, а не malloc/free
+void* operator new(size_t size, std::align_val_t al) { return allocate(size, false, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return allocate(size, false, static_cast<size_t>(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    try { return allocate(size, true, static_cast<size_t>(al)); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    try { return allocate(size, true, static_cast<size_t>(al)); } catch (...) { return nullptr; }
+}
+void operator delete(void* p, std::align_val_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { operator delete(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { operator delete(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { operator delete(p); }
+)CRUN";
+
+// Захват без ожидания (trylock удался) стоит одного атомарного инкремента; backtrace снимается
+// только при ожидании, когда захват и так дорогой.
+static const char* LOCK_SOURCE = R"CRUN(// crun: время ожидания блокировок pthread, подгружается через LD_PRELOAD
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+enum Kind { MUTEX, READ, WRITE, COND, KINDS };
+const char* KIND_NAMES[KINDS] = {"mutex", "rwlock-r", "rwlock-w", "cond"};
+
+const int DEPTH = 24;
+const int SKIP = 2;  // contended() и сама обёртка
+const unsigned LOCKS = 4096, SITES = 1024;
+
+struct Lock {
+    std::atomic<uintptr_t> key;  // адрес * KINDS + вид + 1, 0 — свободная ячейка
+    std::atomic<unsigned long long> acquisitions, contended, waitNs, maxNs;
+};
+
+struct Site {
+    unsigned long long hash;
+    unsigned long long contended, waitNs;
+    int kind, depth;
+    void* frames[DEPTH];
+};
+
+Lock locks[LOCKS];
+Site sites[SITES];
+std::atomic_flag siteLock = ATOMIC_FLAG_INIT;  // только на пути с ожиданием
+std::atomic<unsigned long long> dropped{0};
+char output[4096];
+
+// backtrace и libgcc сами берут мьютексы — их не считаем
+__thread bool busy __attribute__((tls_model("initial-exec")));
+
+template <class F>
+F real(std::atomic<F>& cache, const char* name, const char* version = nullptr) {
+    F f = cache.load(std::memory_order_relaxed);
+    if (!f) {
+        // у pthread_cond_* две версии, без dlvsym можно получить старую несовместимую
+        if (version) f = reinterpret_cast<F>(dlvsym(RTLD_NEXT, name, version));
+        if (!f) f = reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+        cache.store(f, std::memory_order_relaxed);
+    }
+    return f;
+}
+
+unsigned long long now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+Lock* find(const void* address, Kind kind) {
+    uintptr_t key = reinterpret_cast<uintptr_t>(address) * KINDS + kind + 1;
+    unsigned i = static_cast<unsigned>((key * 11400714819323198485ULL) >> 52) % LOCKS;
+    for (unsigned probes = 0; probes < LOCKS; ++probes, i = (i + 1) % LOCKS) {
+        uintptr_t current = locks[i].key.load(std::memory_order_acquire);
+        if (current == key) return &locks[i];
+        if (current == 0 && (locks[i].key.compare_exchange_strong(current, key) || current == key)) return &locks[i];
+    }
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void acquired(const void* address, Kind kind) {
+    if (busy) return;
+    if (Lock* lock = find(address, kind)) lock->acquisitions.fetch_add(1, std::memory_order_relaxed);
+}
+
+__attribute__((noinline)) void contended(const void* address, Kind kind, unsigned long long waitNs, bool ok) {
+    if (busy) return;
+    if (Lock* lock = find(address, kind)) {
+        if (ok) lock->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock->contended.fetch_add(1, std::memory_order_relaxed);
+        lock->waitNs.fetch_add(waitNs, std::memory_order_relaxed);
+        unsigned long long top = lock->maxNs.load(std::memory_order_relaxed);
+        while (waitNs > top && !lock->maxNs.compare_exchange_weak(top, waitNs, std::memory_order_relaxed)) {}
+    }
+
+    busy = true;
+    void* frames[DEPTH + SKIP];
+    int depth = backtrace(frames, DEPTH + SKIP) - SKIP;
+    if (depth > 0) {
+        unsigned long long hash = 1469598103934665603ULL ^ kind;
+        for (int i = 0; i < depth; ++i)
+            hash = (hash ^ reinterpret_cast<unsigned long long>(frames[SKIP + i])) * 1099511628211ULL;
+        hash |= 1;
+
+        while (siteLock.test_and_set(std::memory_order_acquire)) {}
+        unsigned i = static_cast<unsigned>(hash % SITES), probes = 0;
+        while (sites[i].hash && sites[i].hash != hash && ++probes < SITES) i = (i + 1) % SITES;
+        if (probes < SITES) {
+            Site& s = sites[i];
+            if (!s.hash) {
+                s.hash = hash;
+                s.kind = kind;
+                s.depth = depth;
+                memcpy(s.frames, frames + SKIP, depth * sizeof(void*));
+            }
+            ++s.contended;
+            s.waitNs += waitNs;
+        }
+        else dropped.fetch_add(1, std::memory_order_relaxed);
+        siteLock.clear(std::memory_order_release);
+    }
+    busy = false;
+}
+
+// после fork ребёнок начинает счёт заново, иначе отчёт родителя учтётся дважды
+void resetChild() {
+    for (auto& l : locks) {
+        l.key.store(0);
+        l.acquisitions.store(0);
+        l.contended.store(0);
+        l.waitNs.store(0);
+        l.maxNs.store(0);
+    }
+    memset(sites, 0, sizeof(sites));
+    siteLock.clear();
+}
+
+void put(int fd, const char* text) {
+    size_t left = strlen(text);
+    while (left > 0) {
+        ssize_t n = write(fd, text, left);
+        if (n <= 0) return;
+        text += n;
+        left -= n;
+    }
+}
+
+__attribute__((constructor)) void start() {
+    const char* out = getenv("CRUN_LOCKS_OUT");
+    if (out) snprintf(output, sizeof(output), "%s", out);
+    // первый backtrace подгружает libgcc_s — делаем это заранее
+    busy = true;
+    void* frame;
+    backtrace(&frame, 1);
+    busy = false;
+    pthread_atfork(nullptr, nullptr, resetChild);
+}
+
+__attribute__((destructor)) void finish() {
+    if (!output[0]) return;
+    busy = true;
+    char path[4200], line[4600], exe[4096];
+    snprintf(path, sizeof(path), "%s.%d", output, static_cast<int>(getpid()));
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    exe[n > 0 ? n : 0] = 0;
+
+    snprintf(line, sizeof(line), "dropped\t%llu\n", dropped.load());
+    put(fd, line);
+    for (auto& l : locks) {
+        uintptr_t key = l.key.load();
+        if (!key) continue;
+        char* address = reinterpret_cast<char*>((key - 1) / KINDS);
+        snprintf(line, sizeof(line), "lock\t%s\t%llu\t%llu\t%llu\t%llu\t%p", KIND_NAMES[(key - 1) % KINDS],
+                 l.acquisitions.load(), l.contended.load(), l.waitNs.load(), l.maxNs.load(), static_cast<void*>(address));
+        put(fd, line);
+        // глобальные блокировки лежат в .data/.bss модуля, crun найдёт их по символу
+        Dl_info info;
+        if (dladdr(address, &info) && info.dli_fbase) {
+            const char* module = info.dli_fname && info.dli_fname[0] == '/' ? info.dli_fname : exe;
+            snprintf(line, sizeof(line), "\t0x%lx %s",
+                     static_cast<unsigned long>(address - static_cast<char*>(info.dli_fbase)), module);
+            put(fd, line);
+        }
+        put(fd, "\n");
+    }
+
+    // адрес возврата указывает за call, -1 попадает внутрь вызывающей функции
+    for (auto& s : sites) {
+        if (!s.hash) continue;
+        snprintf(line, sizeof(line), "site\t%s\t%llu\t%llu", KIND_NAMES[s.kind], s.contended, s.waitNs);
+        put(fd, line);
+        for (int i = 0; i < s.depth; ++i) {
+            Dl_info info;
+            if (!dladdr(static_cast<char*>(s.frames[i]) - 1, &info) || !info.dli_fbase) continue;
+            const char* module = info.dli_fname && info.dli_fname[0] == '/' ? info.dli_fname : exe;
+            snprintf(line, sizeof(line), "\t0x%lx %s",
+                     static_cast<unsigned long>(static_cast<char*>(s.frames[i]) - 1 - static_cast<char*>(info.dli_fbase)),
+                     module);
+            put(fd, line);
+        }
+        put(fd, "\n");
+    }
+    close(fd);
+}
+
+using MutexFn = int (*)(pthread_mutex_t*);
+using MutexTimedFn = int (*)(pthread_mutex_t*, const timespec*);
+using RwFn = int (*)(pthread_rwlock_t*);
+using RwTimedFn = int (*)(pthread_rwlock_t*, const timespec*);
+using CondFn = int (*)(pthread_cond_t*, pthread_mutex_t*);
+using CondTimedFn = int (*)(pthread_cond_t*, pthread_mutex_t*, const timespec*);
+
+std::atomic<MutexFn> mutexLock, mutexTrylock;
+std::atomic<MutexTimedFn> mutexTimedlock;
+std::atomic<RwFn> rdlock, tryrdlock, wrlock, trywrlock;
+std::atomic<RwTimedFn> timedrdlock, timedwrlock;
+std::atomic<CondFn> condWait;
+std::atomic<CondTimedFn> condTimedwait;
+
+// общий путь: сначала без ожидания, если занято — ждём с замером
+template <class T, class Try, class Lock>
+int lockWith(T* object, Kind kind, Try tryLock, Lock lock) {
+    if (busy) return lock();
+    int tried = tryLock();
+    // только "занято" ведёт к ожиданию; остальное (EOWNERDEAD у robust mutex — блокировка уже наша,
+    // EINVAL и т.п.) программа должна получить как есть, второй lock() его бы скрыл или завис
+    if (tried != EBUSY && !(kind != MUTEX && tried == EAGAIN)) {
+        if (tried == 0 || tried == EOWNERDEAD) acquired(object, kind);
+        return tried;
+    }
+    unsigned long long begin = now();
+    int result = lock();
+    contended(object, kind, now() - begin, result == 0);
+    return result;
+}
+}  // namespace
+
+extern "C" {
+int pthread_mutex_lock(pthread_mutex_t* m) {
+    MutexFn lock = real(mutexLock, "pthread_mutex_lock");
+    MutexFn tryLock = real(mutexTrylock, "pthread_mutex_trylock");
+    return lockWith(m, MUTEX, [&] { return tryLock(m); }, [&] { return lock(m); });
+}
+
+int pthread_mutex_timedlock(pthread_mutex_t* m, const timespec* abstime) {
+    MutexTimedFn lock = real(mutexTimedlock, "pthread_mutex_timedlock");
+    MutexFn tryLock = real(mutexTrylock, "pthread_mutex_trylock");
+    return lockWith(m, MUTEX, [&] { return tryLock(m); }, [&] { return lock(m, abstime); });
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rw) {
+    RwFn lock = real(rdlock, "pthread_rwlock_rdlock");
+    RwFn tryLock = real(tryrdlock, "pthread_rwlock_tryrdlock");
+    return lockWith(rw, READ, [&] { return tryLock(rw); }, [&] { return lock(rw); });
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rw) {
+    RwFn lock = real(wrlock, "pthread_rwlock_wrlock");
+    RwFn tryLock = real(trywrlock, "pthread_rwlock_trywrlock");
+    return lockWith(rw, WRITE, [&] { return tryLock(rw); }, [&] { return lock(rw); });
+}
+
+int pthread_rwlock_timedrdlock(pthread_rwlock_t* rw, const timespec* abstime) {
+    RwTimedFn lock = real(timedrdlock, "pthread_rwlock_timedrdlock");
+    RwFn tryLock = real(tryrdlock, "pthread_rwlock_tryrdlock");
+    return lockWith(rw, READ, [&] { return tryLock(rw); }, [&] { return lock(rw, abstime); });
+}
+
+int pthread_rwlock_timedwrlock(pthread_rwlock_t* rw, const timespec* abstime) {
+    RwTimedFn lock = real(timedwrlock, "pthread_rwlock_timedwrlock");
+    RwFn tryLock = real(trywrlock, "pthread_rwlock_trywrlock");
+    return lockWith(rw, WRITE, [&] { return tryLock(rw); }, [&] { return lock(rw, abstime); });
+}
+
+// ожидание условия — не конкуренция, а простой потока; считаем отдельно и без стеков
+int pthread_cond_wait(pthread_cond_t* c, pthread_mutex_t* m) {
+    CondFn wait = real(condWait, "pthread_cond_wait", "GLIBC_2.3.2");
+    if (busy) return wait(c, m);
+    unsigned long long begin = now();
+    int result = wait(c, m);
+    if (Lock* lock = find(c, COND)) {
+        lock->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock->waitNs.fetch_add(now() - begin, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+int pthread_cond_timedwait(pthread_cond_t* c, pthread_mutex_t* m, const timespec* abstime) {
+    CondTimedFn wait = real(condTimedwait, "pthread_cond_timedwait", "GLIBC_2.3.2");
+    if (busy) return wait(c, m, abstime);
+    unsigned long long begin = now();
+    int result = wait(c, m, abstime);
+    if (Lock* lock = find(c, COND)) {
+        lock->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock->waitNs.fetch_add(now() - begin, std::memory_order_relaxed);
+    }
+    return result;
+}
+}
+)CRUN";
+
+// private: пишет файл, только если содержимое изменилось (иначе не пересобираем)
+static bool updateFile(const fs::path& path, const string& content) {
+    std::ifstream in(path, std::ios::binary);
+    if (in.is_open()) {
+        std::stringstream current;
+        current << in.rdbuf();
+        if (current.str() == content) return false;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+    return true;
+}
+
+// private: <build>/crun_<name>.so из встроенного исходника; пустая строка, если не собрался
+static string buildInterposer(const string& name, const char* source, const string& what) {
+    fs::path folder = fs::absolute(arguments.buildFolder);
+    fs::path cpp = folder / ("crun_" + name + ".cpp");
+    fs::path library = folder / ("crun_" + name + ".so");
+    std::error_code ec;
+
+    bool changed = updateFile(cpp, source);
+    if (changed || !fs::exists(library, ec)) {
+        logMessage(INFO, "Сборка " + what, true, "⚒️");
+        string cmd = "g++ -std=c++17 -shared -fPIC -O2 -pthread -o \"" + library.string() + "\" \"" + cpp.string() +
+                     "\" -ldl";
+        if (system(cmd.c_str()) != 0) {
+            fs::remove(library, ec);
+            logMessage(FAULT, "Не удалось собрать " + what);
+            return "";
+        }
+    }
+    return library.string();
+}
+
+// private: файлы отчётов <prefix>.<pid>
+static std::vector<fs::path> reportFiles(const string& prefix) {
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (auto& entry : fs::directory_iterator(fs::path(prefix).parent_path(), ec))
+        if (entry.path().string().rfind(prefix + ".", 0) == 0) files.push_back(entry.path());
+    return files;
+}
+
+// private: префикс отчётов; заодно удаляет те, что не забрали в прошлый раз (например, после kill)
+static string reportPrefix(const string& suffix) {
+    string prefix = (fs::absolute(arguments.buildFolder) / (arguments.name + suffix)).string();
+    std::error_code ec;
+    for (auto& file : reportFiles(prefix)) fs::remove(file, ec);
+    return prefix;
+}
+
+bool prepareHeapProfiler(std::vector<string>& env) {
+    string library = buildInterposer("heap", HEAP_SOURCE, "профилировщика кучи");
+    if (library.empty()) return false;
+    heapPrefix = reportPrefix(".heap");
+    setEnvVar(env, "LD_PRELOAD", library, ':');
+    setEnvVar(env, "CRUN_HEAP_OUT", heapPrefix);
+    setEnvVar(env, "CRUN_HEAP_RATE", std::to_string(HEAP_RATE));
+    return true;
+}
+
+// private: "0x1a2b /usr/lib/libfoo.so" → имя функции
+static string symbolizeFrame(const string& frame) {
+    size_t space = frame.find(' ');
+    if (space == string::npos) return "[unknown]";
+    unsigned long long offset = std::strtoull(frame.c_str(), nullptr, 16);
+    return symbolizeModuleOffset(frame.substr(space + 1), offset);
+}
+
+// private: STL, operator new, обёртки gthread и функции без символов (libstdc++, загрузчик)
+static bool isLibraryFrame(const string& name) {
+    if (name.empty() || name[0] == '[' || name.rfind("operator new", 0) == 0 || name.rfind("__gthread", 0) == 0)
+        return true;
+    // у шаблонов demangle пишет тип результата перед именем: "void std::vector<...>::_M_realloc_insert(...)"
+    string qualified = name.substr(0, name.find('('));
+    size_t depth = 0, start = 0;
+    for (size_t i = 0; i < qualified.size(); ++i) {
+        if (qualified[i] == '<') ++depth;
+        else if (qualified[i] == '>' && depth > 0) --depth;
+        else if (qualified[i] == ' ' && depth == 0) start = i + 1;
+    }
+    return qualified.compare(start, 5, "std::") == 0 || qualified.compare(start, 11, "__gnu_cxx::") == 0;
+}
+
+// private: оставшиеся кадры строки отчёта → "func <- caller <- ..."; библиотечные кадры (STL, std::thread)
+// выбрасываются, остаётся код программы
+static string readStack(std::istringstream& ss, const string& interposer) {
+    string frame, first, stack;
+    size_t depth = 0;
+    while (depth < SITE_FRAMES && std::getline(ss, frame, '\t')) {
+        if (frame.find(interposer) != string::npos) continue;
+        string name = symbolizeFrame(frame);
+        if (first.empty()) first = name;
+        if (isLibraryFrame(name)) continue;
+        stack += (stack.empty() ? "" : " <- ") + name;
+        ++depth;
+        if (name == "main") break;
+    }
+    if (stack.empty()) stack = first.empty() ? "[unknown]" : first;
+    return stack;
+}
+
+void collectHeapReport(HeapResult& result) {
+    if (heapPrefix.empty()) return;
+    std::map<string, HeapSite> sites;
+    unsigned long long dropped = 0;
+    std::error_code ec;
+
+    for (auto& file : reportFiles(heapPrefix)) {
+        std::ifstream f(file);
+        string line;
+        while (std::getline(f, line)) {
+            std::istringstream ss(line);
+            string key;
+            std::getline(ss, key, line.compare(0, 5, "site\t") == 0 ? '\t' : ' ');
+            if (key != "site") {
+                unsigned long long value = 0;
+                ss >> value;
+                if (key == "malloc") result.mallocCalls += value;
+                else if (key == "realloc") result.reallocCalls += value;
+                else if (key == "free") result.freeCalls += value;
+                else if (key == "new") result.newCalls += value;
+                else if (key == "delete") result.deleteCalls += value;
+                else if (key == "bytes") result.bytes += value;
+                else if (key == "live") result.leaked += value;
+                else if (key == "peak") result.peak = std::max(result.peak, value);
+                else if (key == "rate") result.rate = static_cast<unsigned>(value);
+                else if (key == "dropped") dropped += value;
+                continue;
+            }
+
+            string calls, bytes;
+            std::getline(ss, calls, '\t');
+            std::getline(ss, bytes, '\t');
+            string stack = readStack(ss, "crun_heap.so");
+            HeapSite& site = sites[stack];
+            site.stack = stack;
+            site.calls += std::strtoull(calls.c_str(), nullptr, 10);
+            site.bytes += std::strtoull(bytes.c_str(), nullptr, 10);
+        }
+        fs::remove(file, ec);
+        ++result.processes;
+    }
+    if (result.processes == 0) return;
+
+    for (auto& s : sites) result.sites.push_back(s.second);
+    std::sort(result.sites.begin(), result.sites.end(),
+              [](const HeapSite& a, const HeapSite& b) { return a.bytes > b.bytes; });
+    if (dropped > 0) logMessage(WARN, "Таблица мест выделения переполнилась, " + std::to_string(dropped) +
+                                          " сэмплов отброшено", true);
+    result.ok = true;
+}
+
+bool prepareLockProfiler(std::vector<string>& env) {
+    string library = buildInterposer("locks", LOCK_SOURCE, "профилировщика блокировок");
+    if (library.empty()) return false;
+    lockPrefix = reportPrefix(".locks");
+    setEnvVar(env, "LD_PRELOAD", library, ':');
+    setEnvVar(env, "CRUN_LOCKS_OUT", lockPrefix);
+    return true;
+}
+
+void collectLockReport(LockResult& result) {
+    if (lockPrefix.empty()) return;
+    std::map<string, LockStat> locks;
+    std::map<string, LockSite> sites;
+    unsigned long long dropped = 0;
+    std::error_code ec;
+
+    for (auto& file : reportFiles(lockPrefix)) {
+        std::ifstream f(file);
+        string line;
+        while (std::getline(f, line)) {
+            std::istringstream ss(line);
+            string key, kind;
+            std::getline(ss, key, '\t');
+            if (key == "dropped") {
+                string value;
+                std::getline(ss, value, '\t');
+                dropped += std::strtoull(value.c_str(), nullptr, 10);
+                continue;
+            }
+            std::getline(ss, kind, '\t');
+            if (key == "lock") {
+                string acquisitions, contended, wait, maxWait, address, object;
+                std::getline(ss, acquisitions, '\t');
+                std::getline(ss, contended, '\t');
+                std::getline(ss, wait, '\t');
+                std::getline(ss, maxWait, '\t');
+                std::getline(ss, address, '\t');
+                std::getline(ss, object, '\t');
+                // глобальный объект называем по символу, остальные (куча, стек) — по адресу
+                string name = object.empty() ? "" : symbolizeFrame(object);
+                if (name.empty() || name[0] == '[') name = address;
+
+                LockStat& lock = locks[kind + ' ' + name];
+                lock.kind = kind;
+                lock.name = name;
+                lock.acquisitions += std::strtoull(acquisitions.c_str(), nullptr, 10);
+                lock.contended += std::strtoull(contended.c_str(), nullptr, 10);
+                lock.waitNs += std::strtoull(wait.c_str(), nullptr, 10);
+                lock.maxWaitNs = std::max<unsigned long long>(lock.maxWaitNs, std::strtoull(maxWait.c_str(), nullptr, 10));
+            }
+            else if (key == "site") {
+                string contended, wait;
+                std::getline(ss, contended, '\t');
+                std::getline(ss, wait, '\t');
+                string stack = readStack(ss, "crun_locks.so");
+                LockSite& site = sites[kind + ' ' + stack];
+                site.kind = kind;
+                site.stack = stack;
+                site.contended += std::strtoull(contended.c_str(), nullptr, 10);
+                site.waitNs += std::strtoull(wait.c_str(), nullptr, 10);
+            }
+        }
+        fs::remove(file, ec);
+        ++result.processes;
+    }
+    if (result.processes == 0) return;
+
+    for (auto& l : locks) {
+        if (l.second.kind == "cond") {
+            result.condWaits += l.second.acquisitions;
+            result.condWaitNs += l.second.waitNs;
+            continue;
+        }
+        result.acquisitions += l.second.acquisitions;
+        result.contended += l.second.contended;
+        result.waitNs += l.second.waitNs;
+        result.locks.push_back(l.second);
+    }
+    for (auto& s : sites) result.sites.push_back(s.second);
+    std::sort(result.locks.begin(), result.locks.end(),
+              [](const LockStat& a, const LockStat& b) { return a.waitNs > b.waitNs; });
+    std::sort(result.sites.begin(), result.sites.end(),
+              [](const LockSite& a, const LockSite& b) { return a.waitNs > b.waitNs; });
+    if (dropped > 0) logMessage(WARN, "Таблица блокировок переполнилась, " + std::to_string(dropped) +
+                                          " событий отброшено", true);
+    result.ok = true;
+}
+#endif
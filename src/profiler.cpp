@@ -0,0 +1,698 @@
+#include "../profiler.hpp"
+
+#ifndef _WIN32
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../args.hpp"
+#include "../flamegraph.hpp"
+#include "../logger.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+static const unsigned PERF_FREQUENCY = 999;  // не кратно таймерам программы
+static const auto PTRACE_INTERVAL = std::chrono::milliseconds(10);
+static const size_t MAX_FRAMES = 127;
+
+// ---------------- сбор стеков ----------------
+
+struct Mapping {
+    uint64_t start, end, pgoff;
+    int file;
+};
+
+enum class Mode { NONE, PERF, PTRACE };
+
+static Mode mode = Mode::NONE;
+static std::vector<string> names;  // файлы и comm
+static std::unordered_map<string, int> nameIds;
+static std::unordered_map<pid_t, std::vector<Mapping>> mappings;
+static std::unordered_map<pid_t, int> comms;
+// кадр = (id файла + 1) << 48 | смещение в файле; 0 << 48 | адрес, если отображение неизвестно
+static std::map<std::vector<uint64_t>, unsigned long long> stacks;
+static unsigned long long samples = 0, lost = 0;
+
+// private
+static int nameId(const string& name) {
+    auto it = nameIds.find(name);
+    if (it != nameIds.end()) return it->second;
+    names.push_back(name);
+    return nameIds[name] = static_cast<int>(names.size() - 1);
+}
+
+// private: /proc/<pid>/maps — для режима ptrace и для уже запущенного процесса
+static void loadMappings(pid_t pid) {
+    std::vector<Mapping>& list = mappings[pid];
+    list.clear();
+    std::ifstream f("/proc/" + std::to_string(pid) + "/maps");
+    string line;
+    while (std::getline(f, line)) {
+        // 55d0c6a00000-55d0c6a21000 r-xp 00002000 08:01 1234   /usr/bin/prog
+        unsigned long long start, end, pgoff;
+        char perms[8];
+        int consumed = 0;
+        if (sscanf(line.c_str(), "%llx-%llx %7s %llx %*s %*s %n", &start, &end, perms, &pgoff, &consumed) != 4) continue;
+        if (perms[2] != 'x' || consumed <= 0 || static_cast<size_t>(consumed) >= line.size()) continue;
+        string path = line.substr(static_cast<size_t>(consumed));
+        if (path.empty() || path[0] != '/') continue;
+        list.push_back({start, end, pgoff, nameId(path)});
+    }
+}
+
+// private: сэмпл → ключ стека (корень первым, как в folded-формате)
+static void addSample(pid_t pid, const uint64_t* ips, size_t count) {
+    std::vector<uint64_t> key;
+    key.reserve(count + 1);
+    auto comm = comms.find(pid);
+    key.push_back(comm != comms.end() ? static_cast<uint64_t>(comm->second) : static_cast<uint64_t>(nameId("?")));
+
+    auto& list = mappings[pid];
+    for (size_t i = count; i-- > 0;) {
+        // адреса возврата указывают за call — смещаем внутрь вызывающей функции
+        uint64_t ip = i == 0 ? ips[i] : ips[i] - 1;
+        uint64_t frame = ip;
+        for (auto m = list.rbegin(); m != list.rend(); ++m) {
+            if (ip >= m->start && ip < m->end) {
+                frame = (static_cast<uint64_t>(m->file) + 1) << 48 | (ip - m->start + m->pgoff);
+                break;
+            }
+        }
+        key.push_back(frame);
+    }
+    ++stacks[key];
+    ++samples;
+}
+
+// ---------------- символы ELF ----------------
+
+struct Symbol {
+    uint64_t start, size;
+    string name;
+};
+
+struct ElfImage {
+    std::vector<Symbol> symbols;  // по возрастанию адреса
+    std::vector<Elf64_Phdr> loads;
+};
+
+// private: .symtab, а если вырезан — .dynsym
+static ElfImage loadElf(const string& path) {
+    ElfImage image;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return image;
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Elf64_Ehdr))) {
+        close(fd);
+        return image;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return image;
+
+    const char* base = static_cast<const char*>(data);
+    auto* eh = reinterpret_cast<const Elf64_Ehdr*>(base);
+    bool valid = memcmp(eh->e_ident, ELFMAG, SELFMAG) == 0 && eh->e_ident[EI_CLASS] == ELFCLASS64 &&
+                 eh->e_phoff + eh->e_phnum * sizeof(Elf64_Phdr) <= size &&
+                 eh->e_shoff + eh->e_shnum * sizeof(Elf64_Shdr) <= size;
+    if (valid) {
+        auto* ph = reinterpret_cast<const Elf64_Phdr*>(base + eh->e_phoff);
+        for (int i = 0; i < eh->e_phnum; ++i)
+            if (ph[i].p_type == PT_LOAD) image.loads.push_back(ph[i]);
+
+        auto* sh = reinterpret_cast<const Elf64_Shdr*>(base + eh->e_shoff);
+        for (Elf64_Word wanted : {SHT_SYMTAB, SHT_DYNSYM}) {
+            for (int i = 0; i < eh->e_shnum; ++i) {
+                if (sh[i].sh_type != wanted || sh[i].sh_link >= eh->e_shnum) continue;
+                const Elf64_Shdr& strtab = sh[sh[i].sh_link];
+                if (sh[i].sh_offset + sh[i].sh_size > size || strtab.sh_offset + strtab.sh_size > size) continue;
+                auto* syms = reinterpret_cast<const Elf64_Sym*>(base + sh[i].sh_offset);
+                size_t count = sh[i].sh_size / sizeof(Elf64_Sym);
+                for (size_t j = 0; j < count; ++j) {
+                    // объекты нужны, чтобы называть глобальные мьютексы; с кодом их диапазоны не пересекаются
+                    unsigned char type = ELF64_ST_TYPE(syms[j].st_info);
+                    if ((type != STT_FUNC && !(type == STT_OBJECT && syms[j].st_size > 0)) || syms[j].st_value == 0 ||
+                        syms[j].st_shndx == SHN_UNDEF || syms[j].st_name >= strtab.sh_size)
+                        continue;
+                    image.symbols.push_back({syms[j].st_value, syms[j].st_size, base + strtab.sh_offset + syms[j].st_name});
+                }
+            }
+            if (!image.symbols.empty()) break;
+        }
+        std::sort(image.symbols.begin(), image.symbols.end(),
+                  [](const Symbol& a, const Symbol& b) { return a.start < b.start; });
+    }
+    munmap(data, size);
+    return image;
+}
+
+// private
+static string demangle(const string& name) {
+    int status = 0;
+    char* out = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+    if (status != 0 || !out) return name;
+    string result = out;
+    free(out);
+    return result;
+}
+
+// private: функция, содержащая виртуальный адрес; пустая строка, если не найдена
+static string symbolAt(const ElfImage& image, uint64_t vaddr) {
+    auto sym = std::upper_bound(image.symbols.begin(), image.symbols.end(), vaddr,
+                                [](uint64_t a, const Symbol& s) { return a < s.start; });
+    if (sym == image.symbols.begin()) return "";
+    --sym;
+    // символы без размера (_init перед .plt и т.п.) не покрывают следующий за ними код
+    if (vaddr >= sym->start + sym->size && !(sym->size == 0 && vaddr == sym->start)) return "";
+    string name = demangle(sym->name);
+    // folded-формат не допускает ';' внутри кадра
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+}
+
+// private: кадр → имя функции
+static string symbolize(uint64_t frame, std::unordered_map<int, ElfImage>& images) {
+    int file = static_cast<int>(frame >> 48) - 1;
+    if (file < 0) return "[unknown]";
+    uint64_t offset = frame & ((1ULL << 48) - 1);
+
+    auto it = images.find(file);
+    if (it == images.end()) it = images.emplace(file, loadElf(names[file])).first;
+    const ElfImage& image = it->second;
+
+    for (auto& load : image.loads) {
+        if (offset < load.p_offset || offset >= load.p_offset + load.p_filesz) continue;
+        string name = symbolAt(image, offset - load.p_offset + load.p_vaddr);
+        if (!name.empty()) return name;
+        break;
+    }
+    return "[" + fs::path(names[file]).filename().string() + "]";
+}
+
+string symbolizeModuleOffset(const string& module, unsigned long long offset) {
+    static std::unordered_map<string, ElfImage> images;
+    auto it = images.find(module);
+    if (it == images.end()) it = images.emplace(module, loadElf(module)).first;
+    const ElfImage& image = it->second;
+
+    // dladdr отдаёт смещение от начала первого PT_LOAD (у ET_EXEC это не ноль)
+    uint64_t base = ~0ULL;
+    for (auto& load : image.loads) base = std::min<uint64_t>(base, load.p_vaddr & ~(load.p_align ? load.p_align - 1 : 0));
+    string name = image.loads.empty() ? "" : symbolAt(image, offset + base);
+    return name.empty() ? "[" + fs::path(module).filename().string() + "]" : name;
+}
+
+// ---------------- perf_event ----------------
+
+struct Ring {
+    int fd;
+    void* base;
+};
+
+// inherit-событие нельзя отобразить в память с cpu = -1, поэтому по кольцу на каждый CPU
+static std::vector<Ring> rings;
+static size_t ringSize = 0;
+static const size_t RING_PAGES = 128;  // + страница заголовка, в пределах perf_event_mlock_kb
+static size_t ringPages = RING_PAGES;  // меньше RING_PAGES, если на все CPU не хватило mlock-лимита
+static std::thread drainer;
+static std::atomic<bool> drainStop{false};
+
+// запись кольца, ждущая своей очереди: кольца разных CPU разбираются вперемешку по времени
+struct PendingRecord {
+    uint64_t time;  // CLOCK_MONOTONIC, нс (use_clockid)
+    std::vector<char> data;
+};
+static std::vector<PendingRecord> pending;
+
+// private
+static uint64_t monotonicNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// private: разбор одной записи; body — после заголовка, size — без заголовка
+static void applyRecord(const perf_event_header& header, const char* body, size_t size) {
+    switch (header.type) {
+    case PERF_RECORD_SAMPLE: {
+        // ip, pid/tid, time, callchain (порядок полей задаёт sample_type)
+        uint32_t pid;
+        uint64_t nr;
+        memcpy(&pid, body + 8, 4);
+        memcpy(&nr, body + 24, 8);
+        const uint64_t* chain = reinterpret_cast<const uint64_t*>(body + 32);
+        if (32 + nr * 8 > size) break;
+        uint64_t ips[MAX_FRAMES + 1];
+        size_t count = 0;
+        for (uint64_t i = 0; i < nr && count <= MAX_FRAMES; ++i)
+            if (chain[i] < PERF_CONTEXT_MAX) ips[count++] = chain[i];
+        if (count > 0) addSample(static_cast<pid_t>(pid), ips, count);
+        break;
+    }
+    case PERF_RECORD_MMAP: {
+        uint32_t pid;
+        uint64_t addr, len, pgoff;
+        memcpy(&pid, body, 4);
+        memcpy(&addr, body + 8, 8);
+        memcpy(&len, body + 16, 8);
+        memcpy(&pgoff, body + 24, 8);
+        string file(body + 32, strnlen(body + 32, size - 32));
+        if (!file.empty() && file[0] == '/') mappings[pid].push_back({addr, addr + len, pgoff, nameId(file)});
+        break;
+    }
+    case PERF_RECORD_COMM: {
+        uint32_t pid, tid;
+        memcpy(&pid, body, 4);
+        memcpy(&tid, body + 4, 4);
+        if (pid != tid) break;
+        // после exec адресное пространство новое
+        if (header.misc & PERF_RECORD_MISC_COMM_EXEC) mappings[pid].clear();
+        comms[pid] = nameId(string(body + 8, strnlen(body + 8, size - 8)));
+        break;
+    }
+    case PERF_RECORD_FORK: {
+        // fork копирует отображения родителя без записей MMAP
+        uint32_t pid, ppid;
+        memcpy(&pid, body, 4);
+        memcpy(&ppid, body + 4, 4);
+        if (pid == ppid) break;
+        mappings[pid] = mappings[ppid];
+        if (comms.count(ppid)) comms[pid] = comms[ppid];
+        break;
+    }
+    case PERF_RECORD_LOST: {
+        uint64_t count;
+        memcpy(&count, body + 8, 8);
+        lost += count;
+        break;
+    }
+    default: break;
+    }
+}
+
+// private: переносит записи кольца в pending с их временем
+static void drainRing(void* ring) {
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto* meta = static_cast<perf_event_mmap_page*>(ring);
+    const char* data = static_cast<const char*>(ring) + pageSize;
+    const uint64_t dataSize = ringPages * pageSize;
+
+    uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = meta->data_tail;
+    while (tail < head) {
+        perf_event_header header;
+        for (size_t i = 0; i < sizeof(header); ++i)
+            reinterpret_cast<char*>(&header)[i] = data[(tail + i) % dataSize];
+        if (header.size < sizeof(header)) break;
+        PendingRecord record{0, std::vector<char>(header.size)};
+        for (size_t i = 0; i < header.size; ++i) record.data[i] = data[(tail + i) % dataSize];
+        tail += header.size;
+
+        // у сэмпла время после ip и pid/tid, у остальных (sample_id_all) — последнее поле записи
+        const char* body = record.data.data() + sizeof(header);
+        size_t size = header.size - sizeof(header);
+        if (header.type == PERF_RECORD_SAMPLE && size >= 24) memcpy(&record.time, body + 16, 8);
+        else if (header.type != PERF_RECORD_SAMPLE && size >= 8) memcpy(&record.time, body + size - 8, 8);
+        pending.push_back(std::move(record));
+    }
+    __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+// private: применяет по порядку времени записи не новее upTo: иначе exec из одного кольца стёр бы
+// отображения, уже прочитанные из другого, а сэмплы попали бы раньше своих MMAP
+static void applyPending(uint64_t upTo) {
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const PendingRecord& a, const PendingRecord& b) { return a.time < b.time; });
+    size_t applied = 0;
+    for (; applied < pending.size() && pending[applied].time <= upTo; ++applied) {
+        const auto& data = pending[applied].data;
+        perf_event_header header;
+        memcpy(&header, data.data(), sizeof(header));
+        applyRecord(header, data.data() + sizeof(header), data.size() - sizeof(header));
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(applied));
+}
+
+// private
+static void closeRings() {
+    for (auto& r : rings) {
+        munmap(r.base, ringSize);
+        close(r.fd);
+    }
+    rings.clear();
+}
+
+// private: по кольцу на каждый CPU; false — какое-то кольцо не отобразилось, открытые остаются в rings
+static bool openRings(perf_event_attr& attr, pid_t pid) {
+    ringSize = (ringPages + 1) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    for (int cpu = 0; cpu < cpus; ++cpu) {
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, cpu, -1, PERF_FLAG_FD_CLOEXEC));
+        if (fd < 0) continue;  // CPU offline
+        void* base = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            return false;
+        }
+        rings.push_back({fd, base});
+    }
+    return true;
+}
+
+// private
+static bool startPerf(pid_t pid) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;  // cpu-clock работает и без PMU, например в виртуалках
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = PERF_FREQUENCY;
+    attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_CALLCHAIN;
+    // время и у MMAP/COMM/FORK, на общих часах с crun: записи разных CPU сводятся по порядку
+    attr.sample_id_all = 1;
+    attr.use_clockid = 1;
+    attr.clockid = CLOCK_MONOTONIC;
+    attr.inherit = 1;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.mmap = 1;
+    attr.comm = 1;
+    attr.task = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_callchain_kernel = 1;
+
+    // пропущенный CPU — пропущенные сэмплы, поэтому кольца нужны на всех: если на многоядерной машине
+    // кончился RLIMIT_MEMLOCK / perf_event_mlock_kb, пробуем кольца поменьше, потом — ptrace
+    int error = 0;
+    for (ringPages = RING_PAGES; ringPages > 0; ringPages /= 2) {
+        if (openRings(attr, pid)) break;
+        error = errno;
+        closeRings();
+    }
+    if (!ringPages) {
+        logMessage(WARN, string("Не удалось отобразить кольцевые буферы perf на все CPU: ") + strerror(error) +
+                             " (RLIMIT_MEMLOCK / perf_event_mlock_kb)", true);
+        return false;
+    }
+    if (rings.empty()) return false;
+    if (ringPages < RING_PAGES)
+        logMessage(WARN, "Кольцевые буферы perf уменьшены до " + std::to_string(ringPages) +
+                             " страниц из-за mlock-лимита: часть сэмплов может потеряться", true);
+
+    drainStop = false;
+    pending.clear();
+    drainer = std::thread([]() {
+        // записи старше прошлого прохода уже есть во всех кольцах — их можно применять
+        uint64_t watermark = 0;
+        while (!drainStop) {
+            uint64_t now = monotonicNs();
+            for (auto& r : rings) drainRing(r.base);
+            applyPending(watermark);
+            watermark = now;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        for (auto& r : rings) drainRing(r.base);
+        applyPending(UINT64_MAX);
+    });
+    return true;
+}
+
+// ---------------- ptrace ----------------
+
+static std::set<pid_t> tracees;
+static std::set<pid_t> interrupted;
+static std::unordered_map<pid_t, pid_t> tgids;
+
+// private
+static pid_t tgidOf(pid_t tid) {
+    auto it = tgids.find(tid);
+    if (it != tgids.end()) return it->second;
+    pid_t tgid = tid;
+    std::ifstream f("/proc/" + std::to_string(tid) + "/status");
+    string line;
+    while (std::getline(f, line))
+        if (line.compare(0, 5, "Tgid:") == 0) tgid = static_cast<pid_t>(atoi(line.c_str() + 5));
+    return tgids[tid] = tgid;
+}
+
+// private
+static bool isRunning(pid_t tid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", tid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    char buf[512];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return false;
+    buf[n] = '\0';
+    const char* rp = strrchr(buf, ')');
+    return rp && rp[1] == ' ' && rp[2] == 'R';
+}
+
+// private
+static void refreshProcess(pid_t pid) {
+    loadMappings(pid);
+    std::ifstream f("/proc/" + std::to_string(pid) + "/comm");
+    string comm;
+    if (std::getline(f, comm)) comms[pid] = nameId(comm);
+}
+
+// private: раскрутка по frame pointer остановленного потока
+static void sampleStack(pid_t tid) {
+    uint64_t pc = 0, fp = 0;
+#if defined(__x86_64__)
+    user_regs_struct regs{};
+    iovec iov{&regs, sizeof(regs)};
+    if (ptrace(PTRACE_GETREGSET, tid, NT_PRSTATUS, &iov) != 0) return;
+    pc = regs.rip;
+    fp = regs.rbp;
+#elif defined(__aarch64__)
+    user_regs_struct regs{};
+    iovec iov{&regs, sizeof(regs)};
+    if (ptrace(PTRACE_GETREGSET, tid, NT_PRSTATUS, &iov) != 0) return;
+    pc = regs.pc;
+    fp = regs.regs[29];
+#else
+    return;
+#endif
+    pid_t pid = tgidOf(tid);
+    uint64_t ips[MAX_FRAMES + 1];
+    size_t count = 0;
+    ips[count++] = pc;
+    while (fp != 0 && count <= MAX_FRAMES) {
+        uint64_t frame[2];  // сохранённый fp, адрес возврата
+        iovec local{frame, sizeof(frame)}, remote{reinterpret_cast<void*>(fp), sizeof(frame)};
+        if (process_vm_readv(tid, &local, 1, &remote, 1, 0) != sizeof(frame) || frame[1] == 0) break;
+        ips[count++] = frame[1];
+        if (frame[0] <= fp) break;  // стек растёт вниз — иначе цепочка испорчена
+        fp = frame[0];
+    }
+
+    if (!mappings.count(pid)) refreshProcess(pid);
+    auto& list = mappings[pid];
+    // dlopen после последнего чтения maps
+    if (std::none_of(list.begin(), list.end(), [pc](const Mapping& m) { return pc >= m.start && pc < m.end; }))
+        loadMappings(pid);
+    addSample(pid, ips, count);
+}
+
+// private
+static void handleStop(pid_t tid, int status) {
+    if (WIFEXITED(status) || WIFSIGNALED(status)) {
+        tracees.erase(tid);
+        interrupted.erase(tid);
+        tgids.erase(tid);
+        return;
+    }
+    if (!WIFSTOPPED(status)) return;
+
+    int sig = WSTOPSIG(status);
+    int event = status >> 16;
+    if (event == PTRACE_EVENT_STOP) {
+        // наш PTRACE_INTERRUPT или первая остановка нового потока/процесса
+        tracees.insert(tid);
+        if (interrupted.erase(tid)) sampleStack(tid);
+        ptrace(PTRACE_CONT, tid, nullptr, nullptr);
+    }
+    else if (event != 0) {
+        unsigned long child = 0;
+        if (event == PTRACE_EVENT_CLONE || event == PTRACE_EVENT_FORK || event == PTRACE_EVENT_VFORK) {
+            ptrace(PTRACE_GETEVENTMSG, tid, nullptr, &child);
+            if (child) tracees.insert(static_cast<pid_t>(child));
+        }
+        if (event == PTRACE_EVENT_EXEC) refreshProcess(tgidOf(tid));
+        ptrace(PTRACE_CONT, tid, nullptr, nullptr);
+    }
+    else {
+        // обычный сигнал — передаём программе как есть
+        ptrace(PTRACE_CONT, tid, nullptr, reinterpret_cast<void*>(static_cast<long>(sig)));
+    }
+}
+
+// private
+static bool startPtrace(pid_t pid) {
+    long options = PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACEEXEC |
+                   PTRACE_O_EXITKILL;
+    if (ptrace(PTRACE_SEIZE, pid, nullptr, reinterpret_cast<void*>(options)) != 0) return false;
+    tracees = {pid};
+    interrupted.clear();
+    tgids.clear();
+    return true;
+}
+
+// private: отпускаем потомков, переживших корневой процесс
+static void detachAll() {
+    for (pid_t tid : tracees) {
+        if (!interrupted.count(tid)) ptrace(PTRACE_INTERRUPT, tid, nullptr, nullptr);
+        int status = 0;
+        if (waitpid(tid, &status, __WALL) == tid && WIFSTOPPED(status)) ptrace(PTRACE_DETACH, tid, nullptr, nullptr);
+    }
+    tracees.clear();
+    interrupted.clear();
+}
+
+// ---------------- общий интерфейс ----------------
+
+bool startProfiler(pid_t pid) {
+    names.clear();
+    nameIds.clear();
+    mappings.clear();
+    comms.clear();
+    stacks.clear();
+    samples = lost = 0;
+
+    if (startPerf(pid)) mode = Mode::PERF;
+    else if (startPtrace(pid)) {
+        mode = Mode::PTRACE;
+        logMessage(WARN, "perf_event_open недоступен, стеки снимаются через ptrace (выше накладные расходы)", true);
+    }
+    else {
+        mode = Mode::NONE;
+        logMessage(FAULT, "Профилирование недоступно: нет ни perf_event_open, ни ptrace");
+    }
+    return mode != Mode::NONE;
+}
+
+void waitProfiled(pid_t pid) {
+    if (mode != Mode::PTRACE) {
+        siginfo_t info{};
+        while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) != 0 && errno == EINTR) {}
+        return;
+    }
+
+    auto next = std::chrono::steady_clock::now() + PTRACE_INTERVAL;
+    while (true) {
+        // заглядываем без освобождения: корневой зомби нужен монитору и reapProcess
+        siginfo_t info{};
+        if (waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOHANG | WNOWAIT | __WALL) != 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (info.si_pid != 0) {
+            if (info.si_pid == pid && (info.si_code == CLD_EXITED || info.si_code == CLD_KILLED ||
+                                       info.si_code == CLD_DUMPED))
+                break;
+            int status = 0;
+            if (waitpid(info.si_pid, &status, __WALL) == info.si_pid) handleStop(info.si_pid, status);
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next) {
+            // как cpu-clock в perf: спящие потоки (wait, read) в профиль не попадают
+            for (pid_t tid : tracees)
+                if (isRunning(tid) && interrupted.insert(tid).second) ptrace(PTRACE_INTERRUPT, tid, nullptr, nullptr);
+            next += PTRACE_INTERVAL;
+            if (next < now) next = now + PTRACE_INTERVAL;
+        }
+        else std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(next - now, std::chrono::milliseconds(1)));
+    }
+    tracees.erase(pid);
+    detachAll();
+}
+
+void finishProfiler() {
+    if (mode == Mode::PERF) {
+        drainStop = true;
+        if (drainer.joinable()) drainer.join();
+        closeRings();
+    }
+    if (mode == Mode::NONE) return;
+    string how = mode == Mode::PERF ? "perf_event" : "ptrace";
+    mode = Mode::NONE;
+
+    if (samples == 0) {
+        logMessage(WARN, "Профилировщик не получил ни одного сэмпла", true);
+        return;
+    }
+
+    std::unordered_map<int, ElfImage> images;
+    std::unordered_map<uint64_t, string> frameNames;
+    std::unordered_map<string, unsigned long long> self;
+    FoldedStacks folded;
+    for (auto& s : stacks) {
+        string line = names[static_cast<size_t>(s.first[0])];
+        string leaf;
+        for (size_t i = 1; i < s.first.size(); ++i) {
+            auto it = frameNames.find(s.first[i]);
+            if (it == frameNames.end()) it = frameNames.emplace(s.first[i], symbolize(s.first[i], images)).first;
+            line += ';' + it->second;
+            leaf = it->second;
+        }
+        folded[line] += s.second;
+        self[leaf] += s.second;
+    }
+
+    fs::path base = fs::path(arguments.buildFolder) / arguments.name;
+    string foldedPath = base.string() + ".folded", svgPath = base.string() + ".svg";
+    bool ok = writeFolded(folded, foldedPath) &&
+              writeFlameGraph(folded, svgPath, arguments.name + " — " + std::to_string(samples) + " сэмплов (" + how + ")");
+
+    logMessage(INFO, "Профиль (" + how + "): " + std::to_string(samples) + " сэмплов" +
+                         (lost ? ", потеряно " + std::to_string(lost) : ""), true, "🔥");
+    std::vector<std::pair<string, unsigned long long>> hot(self.begin(), self.end());
+    std::sort(hot.begin(), hot.end(), [](auto& a, auto& b) { return a.second > b.second; });
+    for (size_t i = 0; i < hot.size() && i < 10; ++i) {
+        char percent[16];
+        snprintf(percent, sizeof(percent), "%6.2f%%", 100.0 * hot[i].second / samples);
+        logMessageA(INFO, string("    ") + percent + "  " + hot[i].first, true);
+    }
+    if (ok) {
+        logMessageA(INFO, "    Folded:      " + foldedPath, true);
+        logMessageA(INFO, "    Flame graph: " + svgPath, true);
+    }
+    else logMessage(FAULT, "Не удалось записать профиль в " + arguments.buildFolder);
+}
+#endif
@@ -1,13 +1,33 @@
 #include "../runner.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <sstream>
+#include <thread>
+#include <utility>
 
 #include "../args.hpp"
+#include "../bench.hpp"
+#include "../cache.hpp"
+#include "../history.hpp"
+#include "../judge.hpp"
+#include "../load.hpp"
 #include "../logger.hpp"
+#include "../matrix.hpp"
 #include "../monitor.hpp"
+#include "../output.hpp"
+#include "../perf.hpp"
+#include "../preload.hpp"
+#include "../scale.hpp"
+#include "../stress.hpp"
+#include "../profiler.hpp"
+#include "../syscalls.hpp"
+#include "../tuning.hpp"
 
 namespace fs = std::filesystem;
 extern Args arguments;
@@ -17,24 +37,662 @@ using std::string;
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/personality.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
+
+#include <cerrno>
+
+extern char** environ;
+#endif
+
+// private: объёмы, скорости и число системных вызовов ввода-вывода
+static void printIo(const MonitoringResult& result, long long durationMs) {
+    if (!result.io) return;
+    auto mb = [](unsigned long long bytes) { return fixed2(bytes / 1048576.0) + " MB"; };
+    double seconds = durationMs > 0 ? durationMs / 1000.0 : 0;
+    unsigned long long calls = result.ioReadCalls + result.ioWriteCalls;
+
+    logMessageA(INFO, "    I/O чтение:  " + mb(result.ioReadChars) + " (диск " + mb(result.ioReadBytes) + "), пик " +
+                          fixed2(result.ioReadPeakMBs) + " MB/s", true);
+    logMessageA(INFO, "    I/O запись:  " + mb(result.ioWriteChars) + " (диск " + mb(result.ioWriteBytes) + "), пик " +
+                          fixed2(result.ioWritePeakMBs) + " MB/s", true);
+    logMessageA(INFO, "    Syscalls:    read " + std::to_string(result.ioReadCalls) + ", write " +
+                          std::to_string(result.ioWriteCalls) + ", " +
+                          std::to_string(seconds > 0 ? static_cast<unsigned long long>(calls / seconds) : calls) +
+                          "/s (пик " + std::to_string(result.ioCallsPeak) + "/s)", true);
+}
+
+// private: сколько программа вывела в stdout и куда это делось
+static void printOutput(const OutputStats& output, long long durationMs) {
+    string text = fixed2(output.bytes / 1048576.0) + " MB, " + std::to_string(output.lines) + " строк";
+    if (durationMs > 0) text += ", " + fixed2(output.bytes / 1048576.0 * 1000 / durationMs) + " MB/s";
+    if (!output.file.empty()) text += " → " + output.file;
+    else if (arguments.stdoutMode == "discard") text += " (отброшен)";
+    logMessageA(INFO, "    Вывод:       " + text, true);
+}
+
+// private: из чего состояла память в момент пика
+static void printPeakMemory(const MonitoringResult& result) {
+    const MemoryBreakdown& m = result.peakMemory;
+    if (!m.valid) return;
+    auto mb = [](unsigned long long kb) { return fixed2(kb / 1024.0) + " MB"; };
+
+    logMessageA(INFO, "    Память на пике (smaps_rollup):", true);
+    logMessageA(INFO, "       RSS " + mb(m.rss) + ", PSS " + mb(m.pss) + ", USS " + mb(m.uss), true);
+    logMessageA(INFO, "       анонимная " + mb(m.anon) + ", файловая " + mb(m.file) + ", swap " + mb(m.swap), true);
+    if (m.detailed) logMessageA(INFO, "       heap " + mb(m.heap) + ", stack " + mb(m.stack), true);
+}
+
+// private: распределение CPU по потокам
+static void printThreads(const MonitoringResult& result) {
+    if (result.threads.empty()) return;
+
+    logMessageA(INFO, "    Потоков max:     " + std::to_string(result.threadsMax), true);
+    logMessageA(INFO, "    Потоков average: " + std::to_string(result.threadsAverage), true);
+
+    // динамика числа потоков, сжатая до 20 интервалов (максимум в каждом)
+    const auto& timeline = result.threadTimeline;
+    const size_t buckets = timeline.size() < 20 ? timeline.size() : 20;
+    string line;
+    for (size_t b = 0; b < buckets; ++b) {
+        unsigned top = 0;
+        for (size_t i = b * timeline.size() / buckets; i < (b + 1) * timeline.size() / buckets; ++i)
+            if (timeline[i] > top) top = timeline[i];
+        line += ' ' + std::to_string(top);
+    }
+    logMessageA(INFO, "    Потоки по времени:" + line, true);
+
+    unsigned long long total = 0, busy = 0, maxMs = result.threads.front().cpuMs;
+    for (auto& t : result.threads) {
+        total += t.cpuMs;
+        if (t.cpuMs > 0) ++busy;
+    }
+    if (total == 0) return;
+
+    logMessageA(INFO, "    Самые загруженные потоки:", true);
+    for (size_t i = 0; i < result.threads.size() && i < 5; ++i) {
+        auto& t = result.threads[i];
+        if (t.cpuMs == 0) break;
+        logMessageA(INFO, "       " + std::to_string(t.tid) + " (" + t.name + ")  " + std::to_string(t.cpuMs) + " ms  " +
+                              std::to_string(t.cpuMs * 100 / total) + "%", true);
+    }
+    // 1.0 — работа распределена поровну, busy — весь CPU в одном потоке
+    if (busy > 1)
+        logMessageA(INFO, "    Дисбаланс (max/avg): " + fixed2(static_cast<double>(maxMs) * busy / total), true);
+}
+
+// private: на CPU, в очереди планировщика или вне CPU — что стоит за низкой загрузкой
+static void printSched(const SchedStats& sched) {
+    if (!sched.valid) return;
+    unsigned long long total = sched.runMs + sched.waitMs + sched.offCpuMs;
+    if (total == 0) return;
+    auto share = [total](unsigned long long ms) { return std::to_string(ms) + " ms (" + fixed2(100.0 * ms / total) + "%)"; };
+
+    logMessageA(INFO, "    Планировщик (время потоков):", true);
+    logMessageA(INFO, "       на CPU:        " + share(sched.runMs), true);
+    logMessageA(INFO, "       ждали CPU:     " + share(sched.waitMs) +
+                          (sched.timeslices ? ", в среднем " + fixed2(static_cast<double>(sched.waitMs) / sched.timeslices) +
+                                                  " ms на запуск"
+                                            : ""), true);
+    logMessageA(INFO, "       вне CPU:       " + share(sched.offCpuMs) +
+                          (sched.blockKnown ? ", из них D-состояние " + std::to_string(sched.blockMs) + " ms" : ""), true);
+    logMessageA(INFO, "       Миграции: " + std::to_string(sched.migrations) + ", переключения: добровольные " +
+                          std::to_string(sched.voluntarySwitches) + ", вынужденные " +
+                          std::to_string(sched.involuntarySwitches), true);
+
+    // ожидание в очереди — процессу не хватает CPU, вне CPU — он сам ждёт (I/O, блокировки, sleep)
+    if (sched.waitMs * 10 >= total) logMessageA(INFO, "       Потокам не хватает CPU: заметное ожидание в очереди", true);
+    else if (sched.offCpuMs * 2 >= total) logMessageA(INFO, "       Большую часть времени потоки заблокированы или спят", true);
+}
+
+// private: доли TMA уровня 1 и главное узкое место
+static void printTopDown(const TopDown& td) {
+    if (!td.ok) return;
+    const std::pair<const char*, double> buckets[] = {{"Frontend bound", td.frontendBound},
+                                                      {"Bad speculation", td.badSpeculation},
+                                                      {"Backend bound", td.backendBound},
+                                                      {"Retiring", td.retiring}};
+    logMessageA(INFO, "    Top-down (уровень 1):", true);
+    const std::pair<const char*, double>* top = &buckets[0];
+    for (auto& b : buckets) {
+        string name = b.first;
+        logMessageA(INFO, "       " + name + ":" + string(17 - name.size(), ' ') + fixed2(b.second * 100) + "%", true);
+        if (&b != &buckets[3] && b.second > top->second) top = &b;
+    }
+    // Retiring — полезная работа, узким местом считаем только остальные три
+    if (top->second > td.retiring) logMessageA(INFO, string("       Узкое место: ") + top->first, true);
+    if (td.running < 0.99)
+        logMessageA(INFO, "       (группы мультиплексировались, работали " + fixed2(td.running * 100) + "% времени)", true);
+}
+
+// private: счётчики perf рядом со временем выполнения
+static void printPerf(const PerfResult& perf, long long durationMs) {
+    printTopDown(perf.topDown);
+    if (!perf.hardware && !perf.software) return;
+    auto percent = [](const PerfCounter& part, const PerfCounter& whole) {
+        return whole.ok && whole.value ? fixed2(100.0 * part.value / whole.value) + "%" : string("—");
+    };
+
+    if (perf.cycles.ok)
+        logMessageA(INFO, "    Циклы:       " + std::to_string(perf.cycles.value) + (perf.userOnly ? " (user-space)" : ""),
+                    true);
+    if (perf.instructions.ok)
+        logMessageA(INFO, "    Инструкции:  " + std::to_string(perf.instructions.value) +
+                              (perf.cycles.ok && perf.cycles.value
+                                   ? ", IPC " + fixed2(static_cast<double>(perf.instructions.value) / perf.cycles.value)
+                                   : ""), true);
+    if (perf.cacheReferences.ok)
+        logMessageA(INFO, "    Кэш:         обращений " + std::to_string(perf.cacheReferences.value) + ", промахов " +
+                              std::to_string(perf.cacheMisses.value) + " (" +
+                              percent(perf.cacheMisses, perf.cacheReferences) + ")", true);
+    if (perf.branches.ok)
+        logMessageA(INFO, "    Ветвления:   " + std::to_string(perf.branches.value) + ", промахов " +
+                              std::to_string(perf.branchMisses.value) + " (" + percent(perf.branchMisses, perf.branches) +
+                              ")", true);
+    if (perf.taskClock.ok)
+        logMessageA(INFO, "    Task-clock:  " + fixed2(perf.taskClock.value / 1e6) + " ms" +
+                              (durationMs > 0 ? " (" + fixed2(perf.taskClock.value / 1e6 / durationMs) + " CPU)" : ""),
+                    true);
+    if (perf.pageFaults.ok) logMessageA(INFO, "    Page faults: " + std::to_string(perf.pageFaults.value), true);
+
+    double running = 1;
+    for (auto* c : {&perf.cycles, &perf.instructions, &perf.cacheReferences, &perf.branches})
+        if (c->ok && c->running < running) running = c->running;
+    if (running < 0.99)
+        logMessageA(INFO, "    (мультиплексирование: счётчики работали " + fixed2(running * 100) + "% времени)", true);
+}
+
+// private: горячие места выделения памяти
+static void printHeap(const HeapResult& heap) {
+    if (!heap.ok) return;
+    auto mb = [](unsigned long long bytes) { return fixed2(bytes / 1048576.0) + " MB"; };
+
+    logMessage(INFO, "Куча (LD_PRELOAD):", true);
+    logMessageA(INFO, "    malloc " + std::to_string(heap.mallocCalls) + ", realloc " + std::to_string(heap.reallocCalls) +
+                          ", free " + std::to_string(heap.freeCalls) + ", new " + std::to_string(heap.newCalls) +
+                          ", delete " + std::to_string(heap.deleteCalls), true);
+    logMessageA(INFO, "    Выделено " + mb(heap.bytes) + ", пик " + mb(heap.peak) + ", не освобождено к выходу " +
+                          mb(heap.leaked), true);
+    if (heap.processes > 1) logMessageA(INFO, "    Процессов с отчётом: " + std::to_string(heap.processes), true);
+    if (heap.sites.empty()) return;
+
+    logMessageA(INFO, "    Места выделения (оценка по каждой " + std::to_string(heap.rate) + "-й, крупные — все):", true);
+    for (size_t i = 0; i < heap.sites.size() && i < 10; ++i) {
+        string bytes = mb(heap.sites[i].bytes);
+        logMessageA(INFO, "       " + string(bytes.size() < 12 ? 12 - bytes.size() : 0, ' ') + bytes + "  " +
+                              std::to_string(heap.sites[i].calls) + " выз.  " + heap.sites[i].stack, true);
+    }
+}
+
+// private: самые конкурентные блокировки и места, где на них ждут
+static void printLocks(const LockResult& locks) {
+    if (!locks.ok) return;
+    auto ms = [](unsigned long long ns) { return fixed2(ns / 1e6) + " ms"; };
+    auto share = [](unsigned long long part, unsigned long long whole) {
+        return whole ? fixed2(100.0 * part / whole) + "%" : string("0%");
+    };
+
+    logMessage(INFO, "Блокировки (LD_PRELOAD):", true);
+    logMessageA(INFO, "    Захватов " + std::to_string(locks.acquisitions) + ", с ожиданием " +
+                          std::to_string(locks.contended) + " (" + share(locks.contended, locks.acquisitions) +
+                          "), ожидание всего " + ms(locks.waitNs), true);
+    if (locks.condWaits)
+        logMessageA(INFO, "    Ожидание условий: " + std::to_string(locks.condWaits) + " раз, " + ms(locks.condWaitNs),
+                    true);
+    if (locks.contended == 0) return;
+
+    logMessageA(INFO, "    Самые конкурентные:", true);
+    for (size_t i = 0; i < locks.locks.size() && i < 10 && locks.locks[i].contended; ++i) {
+        auto& l = locks.locks[i];
+        logMessageA(INFO, "       " + l.kind + string(l.kind.size() < 9 ? 9 - l.kind.size() : 0, ' ') + l.name +
+                              "  захватов " + std::to_string(l.acquisitions) + ", с ожиданием " +
+                              std::to_string(l.contended) + " (" + share(l.contended, l.acquisitions) + "), " +
+                              ms(l.waitNs) + ", макс " + ms(l.maxWaitNs), true);
+    }
+    logMessageA(INFO, "    Где ждут:", true);
+    for (size_t i = 0; i < locks.sites.size() && i < 10; ++i) {
+        auto& s = locks.sites[i];
+        string wait = ms(s.waitNs);
+        logMessageA(INFO, "       " + string(wait.size() < 12 ? 12 - wait.size() : 0, ' ') + wait + "  " +
+                              std::to_string(s.contended) + " раз  " + s.kind + "  " + s.stack, true);
+    }
+}
+
+// private: таблица в духе strace -c, по убыванию суммарного времени
+static void printSyscalls(const SyscallResult& sc) {
+    if (!sc.ok) return;
+    unsigned long long calls = 0, errors = 0, totalNs = 0;
+    for (auto& c : sc.calls) {
+        calls += c.calls;
+        errors += c.errors;
+        totalNs += c.totalNs;
+    }
+    double seconds = sc.tracedMs / 1000.0;
+    auto perSecond = [seconds](unsigned long long n) {
+        return std::to_string(seconds > 0 ? static_cast<unsigned long long>(n / seconds) : n);
+    };
+    auto cell = [](const string& text, size_t width) {
+        return text.size() >= width ? text : string(width - text.size(), ' ') + text;
+    };
+
+    logMessage(INFO, "Системные вызовы (ptrace" +
+                         (sc.percent < 100 ? ", " + std::to_string(sc.percent) + "% времени" : string()) + "):", true);
+    logMessageA(INFO, "    Всего " + std::to_string(calls) + " вызовов, " + perSecond(calls) + "/s, ошибок " +
+                          std::to_string(errors) + ", в вызовах " + fixed2(totalNs / 1e6) + " ms", true);
+    if (sc.calls.empty()) return;
+
+    logMessageA(INFO, "    вызов                   число   ошибок    всего ms   сред. мкс    макс мкс       в сек", true);
+    for (size_t i = 0; i < sc.calls.size() && i < 15; ++i) {
+        auto& c = sc.calls[i];
+        logMessageA(INFO, "    " + c.name + string(c.name.size() < 18 ? 18 - c.name.size() : 1, ' ') +
+                              cell(std::to_string(c.calls), 11) + cell(std::to_string(c.errors), 9) +
+                              cell(fixed2(c.totalNs / 1e6), 12) + cell(fixed2(c.totalNs / 1e3 / c.calls), 12) +
+                              cell(fixed2(c.maxNs / 1e3), 12) + cell(perSecond(c.calls), 12), true);
+    }
+    if (sc.calls.size() > 15)
+        logMessageA(INFO, "    ... ещё " + std::to_string(sc.calls.size() - 15) + " видов вызовов", true);
+}
+
+#ifndef _WIN32
+// private: окружение crun, к которому запуск добавляет свои переменные
+static std::vector<string> currentEnvironment() {
+    std::vector<string> env;
+    for (char** e = environ; *e; ++e) env.push_back(*e);
+    return env;
+}
+
+// private: простая команда ("путь" и аргументы без спецсимволов shell) разбирается без /bin/sh —
+// меньше шума в замерах и лишнего процесса в дереве; false — нужен shell
+static bool splitCommand(const string& cmd, std::vector<string>& words) {
+    static const string special = "|&;<>()$`\\'*?[]#~{}!\n";
+    words.clear();
+    string word;
+    bool quoted = false, started = false;
+    for (char c : cmd) {
+        if (c == '"') {
+            quoted = !quoted;
+            started = true;
+        }
+        else if (special.find(c) != string::npos) return false;
+        else if (!quoted && (c == ' ' || c == '\t')) {
+            if (started) words.push_back(word);
+            word.clear();
+            started = false;
+        }
+        else {
+            word += c;
+            started = true;
+        }
+    }
+    if (quoted) return false;
+    if (started) words.push_back(word);
+    // без '/' понадобился бы поиск по PATH
+    return !words.empty() && words[0].find('/') != string::npos && words[0].find('=') == string::npos;
+}
+
+int openRunInput() {
+    if (arguments.stdinFile.empty()) return -1;
+    // сам файл, а не pipe: программа читает его прямо из страничного кэша и может делать seek/mmap
+    int fd = open(arguments.stdinFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) logMessage(WARN, "Не удалось открыть -in " + arguments.stdinFile + ": " + strerror(errno));
+    else posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return fd;
+}
+
+pid_t spawnGated(const string& cmd, const std::vector<string>& env, const ChildSetup& setup, int& gate) {
+    // всё, что требует памяти, готовим до fork: в дочернем процессе выделять её уже нельзя
+    std::vector<string> words;
+    bool direct = splitCommand(cmd, words);
+    if (!direct) words = {"sh", "-c", cmd};
+    string path = direct ? words[0] : "/bin/sh";
+    std::vector<char*> argv, envp;
+    for (auto& w : words) argv.push_back(const_cast<char*>(w.c_str()));
+    argv.push_back(nullptr);
+    for (auto& var : env) envp.push_back(const_cast<char*>(var.c_str()));
+    envp.push_back(nullptr);
+
+    int pipeFds[2];
+    if (pipe2(pipeFds, O_CLOEXEC) != 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(pipeFds[1]);
+        char c;
+        while (read(pipeFds[0], &c, 1) < 0 && errno == EINTR) {}
+        if (setup.stdinFd >= 0) dup2(setup.stdinFd, STDIN_FILENO);
+        if (setup.stdoutFd >= 0) dup2(setup.stdoutFd, STDOUT_FILENO);
+        if (setup.stderrFd >= 0) dup2(setup.stderrFd, STDERR_FILENO);
+        if (setup.pinned) sched_setaffinity(0, sizeof(cpu_set_t), &setup.cpus);
+        if (setup.nice) setpriority(PRIO_PROCESS, 0, setup.nice);
+        if (setup.ioPriority >= 0) syscall(SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, 0, setup.ioPriority);
+        // раскладка памяти одинакова от запуска к запуску; флаг наследуется через exec
+        if (setup.noAslr) personality(static_cast<unsigned long>(personality(0xffffffff)) | ADDR_NO_RANDOMIZE);
+        // мягкий лимит CPU присылает SIGXCPU, жёсткий на секунду позже — SIGKILL
+        if (setup.cpuSeconds) {
+            struct rlimit cpu = {setup.cpuSeconds, setup.cpuSeconds + 1};
+            setrlimit(RLIMIT_CPU, &cpu);
+        }
+        if (setup.addressSpace) {
+            struct rlimit as = {setup.addressSpace, setup.addressSpace};
+            setrlimit(RLIMIT_AS, &as);
+        }
+        if (setup.openFiles) {
+            struct rlimit files = {setup.openFiles, setup.openFiles};
+            setrlimit(RLIMIT_NOFILE, &files);
+        }
+        execve(path.c_str(), argv.data(), envp.data());
+        _exit(127);  // если exec не сработал
+    }
+    close(pipeFds[0]);
+    if (pid < 0) {
+        close(pipeFds[1]);
+        return -1;
+    }
+    gate = pipeFds[1];
+    return pid;
+}
+#endif
+
+#ifdef _WIN32
+// private: наследуемый дескриптор -in для hStdInput; INVALID_HANDLE_VALUE — -in не задан или ошибка
+static HANDLE openInputHandle() {
+    if (arguments.stdinFile.empty()) return INVALID_HANDLE_VALUE;
+    SECURITY_ATTRIBUTES sa{sizeof(sa), NULL, TRUE};
+    HANDLE input = CreateFileA(arguments.stdinFile.c_str(), GENERIC_READ, FILE_SHARE_READ, &sa, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (input == INVALID_HANDLE_VALUE) logMessage(WARN, "Не удалось открыть -in: " + arguments.stdinFile);
+    return input;
+}
+
+// private: ждёт процесс не дольше -timeout; true — время вышло и процесс убит
+static bool waitWithDeadline(HANDLE process) {
+    DWORD ms = arguments.timeout > 0 ? static_cast<DWORD>(arguments.timeout * 1000) : INFINITE;
+    if (WaitForSingleObject(process, ms) != WAIT_TIMEOUT) return false;
+    TerminateProcess(process, 1);
+    WaitForSingleObject(process, INFINITE);
+    return true;
+}
+#else
+// private: сторож -timeout — ждёт завершения pid через pidfd и по истечении срока убивает его
+// вместе с cgroup; освобождать pid до join нельзя только на ядрах без pidfd
+static std::thread startDeadline(pid_t pid, const string& cgroup, std::atomic<bool>& expired) {
+    if (arguments.timeout <= 0) return std::thread();
+    return std::thread([pid, cgroup, &expired]() {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(arguments.timeout);
+        auto remainingMs = [&]() {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            return static_cast<int>(std::max<long long>(0, left.count()));
+        };
+        int pidfd = -1;
+#ifdef SYS_pidfd_open
+        pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#endif
+        bool exited = false;
+        if (pidfd >= 0) {
+            struct pollfd p = {pidfd, POLLIN, 0};
+            int r;
+            while ((r = poll(&p, 1, remainingMs())) < 0 && errno == EINTR) {}
+            exited = r != 0;
+        }
+        else {
+            // ядра до 5.3 без pidfd: проверяем раз в 10 мс
+            while (!exited && remainingMs() > 0) {
+                siginfo_t info{};
+                exited = waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) != 0 || info.si_pid == pid;
+                if (!exited) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        if (!exited) {
+            expired = true;
+#ifdef SYS_pidfd_send_signal
+            if (pidfd < 0 || syscall(SYS_pidfd_send_signal, pidfd, SIGKILL, nullptr, 0) != 0) kill(pid, SIGKILL);
+#else
+            kill(pid, SIGKILL);
+#endif
+            killRunCgroup(cgroup);
+        }
+        if (pidfd >= 0) close(pidfd);
+    });
+}
+
+// private: почему программа остановлена не сама; пусто — вышла сама
+static string describeStop(int status, bool expired, bool oom, double cpuMs) {
+    if (expired) return "превышен лимит времени " + fixed2(arguments.timeout) + " s";
+    if (oom) return "превышен лимит памяти " + std::to_string(arguments.memoryLimitMb) + " MB (OOM killer)";
+    if (!WIFSIGNALED(status)) return "";
+    int sig = WTERMSIG(status);
+    if (sig == SIGXCPU || (sig == SIGKILL && arguments.cpuLimit && cpuMs >= arguments.cpuLimit * 1000.0))
+        return "превышен лимит CPU-времени " + std::to_string(arguments.cpuLimit) + " s";
+    string text = "сигнал " + std::to_string(sig) + " (" + strsignal(sig) + ")";
+    if ((arguments.addressLimitMb || arguments.memoryLimitMb) && (sig == SIGSEGV || sig == SIGABRT || sig == SIGBUS))
+        text += ", вероятно, не хватило адресного пространства (-as-limit / -mem-limit)";
+    return text;
+}
 #endif
 
-int runScript(const string& cmd, bool monitoring) {
+RunStats runOnce(const string& cmd, bool quiet, const std::vector<string>& env, const std::vector<int>& cpus,
+                 const string& input, const string& output, bool controls) {
+    RunStats stats;
+#ifdef _WIN32
+    // блок окружения: текущие переменные с заменой тех, что заданы в env
+    string block;
+    if (!env.empty()) {
+        std::vector<string> vars;
+        if (char* strings = GetEnvironmentStringsA()) {
+            for (char* p = strings; *p; p += strlen(p) + 1) vars.push_back(p);
+            FreeEnvironmentStringsA(strings);
+        }
+        for (auto& var : env) {
+            size_t eq = var.find('=');
+            setEnvVar(vars, var.substr(0, eq), eq == string::npos ? "" : var.substr(eq + 1));
+        }
+        for (auto& var : vars) block += var + '\0';
+        block += '\0';
+    }
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << cpu;
+
+    STARTUPINFOA si{};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi{};
+    SECURITY_ATTRIBUTES sa{sizeof(sa), NULL, TRUE};
+    HANDLE nul = INVALID_HANDLE_VALUE, out = INVALID_HANDLE_VALUE;
+    HANDLE in = input.empty() ? (controls ? openInputHandle() : INVALID_HANDLE_VALUE)
+                              : CreateFileA(input.c_str(), GENERIC_READ, FILE_SHARE_READ, &sa, OPEN_EXISTING,
+                                            FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (!output.empty())
+        out = CreateFileA(output.c_str(), GENERIC_WRITE, 0, &sa, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if ((!input.empty() && in == INVALID_HANDLE_VALUE) || (!output.empty() && out == INVALID_HANDLE_VALUE)) {
+        if (in != INVALID_HANDLE_VALUE) CloseHandle(in);
+        if (out != INVALID_HANDLE_VALUE) CloseHandle(out);
+        return stats;
+    }
+    if (quiet || in != INVALID_HANDLE_VALUE || out != INVALID_HANDLE_VALUE) {
+        si.dwFlags = STARTF_USESTDHANDLES;
+        si.hStdInput = in != INVALID_HANDLE_VALUE ? in : GetStdHandle(STD_INPUT_HANDLE);
+        si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+        si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    }
+    if (quiet) {
+        nul = CreateFileA("NUL", GENERIC_WRITE, FILE_SHARE_WRITE, &sa, OPEN_EXISTING, 0, NULL);
+        si.hStdOutput = si.hStdError = nul;
+    }
+    if (out != INVALID_HANDLE_VALUE) si.hStdOutput = out;
+    auto start = std::chrono::steady_clock::now();
+    BOOL started = CreateProcessA(NULL, const_cast<char*>(cmd.c_str()), NULL, NULL, si.dwFlags != 0,
+                                  mask ? CREATE_SUSPENDED : 0, block.empty() ? NULL : const_cast<char*>(block.data()),
+                                  NULL, &si, &pi);
+    if (in != INVALID_HANDLE_VALUE) CloseHandle(in);
+    if (out != INVALID_HANDLE_VALUE) CloseHandle(out);
+    if (!started) {
+        if (nul != INVALID_HANDLE_VALUE) CloseHandle(nul);
+        return stats;
+    }
+    if (mask) {
+        SetProcessAffinityMask(pi.hProcess, mask);
+        ResumeThread(pi.hThread);
+    }
+    if (!controls) WaitForSingleObject(pi.hProcess, INFINITE);
+    else if ((stats.timedOut = waitWithDeadline(pi.hProcess)))
+        stats.stopReason = "превышен лимит времени " + fixed2(arguments.timeout) + " s";
+    stats.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    DWORD exitCode = 0;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    stats.code = static_cast<int>(exitCode);
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(pi.hProcess, &creation, &exit, &kernel, &user)) {
+        auto ms = [](const FILETIME& t) { return (((ULONGLONG)t.dwHighDateTime << 32) | t.dwLowDateTime) / 10000.0; };
+        stats.userMs = ms(user);
+        stats.systemMs = ms(kernel);
+    }
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(pi.hProcess, &pmc, sizeof(pmc))) stats.maxRssKb = pmc.PeakWorkingSetSize / 1024;
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    if (nul != INVALID_HANDLE_VALUE) CloseHandle(nul);
+#else
+    ChildSetup setup;
+    int nul = -1;
+    if (quiet) {
+        nul = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        setup.stdoutFd = setup.stderrFd = nul;
+    }
+    setup.stdinFd = !input.empty() ? open(input.c_str(), O_RDONLY | O_CLOEXEC) : controls ? openRunInput() : -1;
+    int out = output.empty() ? -1 : open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out >= 0) setup.stdoutFd = out;
+    if ((!input.empty() && setup.stdinFd < 0) || (!output.empty() && out < 0)) {
+        if (nul >= 0) close(nul);
+        if (setup.stdinFd >= 0) close(setup.stdinFd);
+        if (out >= 0) close(out);
+        return stats;
+    }
+    std::vector<string> environment = currentEnvironment();
+    for (auto& var : env) {
+        size_t eq = var.find('=');
+        setEnvVar(environment, var.substr(0, eq), eq == string::npos ? "" : var.substr(eq + 1));
+    }
+    if (!cpus.empty()) {
+        setup.pinned = true;
+        for (int cpu : cpus) CPU_SET(cpu, &setup.cpus);
+    }
+    if (controls) applyRunControls(setup);
+    // -mem-limit, как и в runScript, — memory.max своей cgroup, чтобы превышение было видно как OOM
+    string cgroup = controls && arguments.memoryLimitMb ? createRunCgroup() : "";
+    bool memoryLimited = limitRunCgroup(cgroup, arguments.memoryLimitMb * 1024 * 1024);
+    if (memoryLimited) setup.addressSpace = arguments.addressLimitMb * 1024 * 1024;
+    else {
+        removeRunCgroup(cgroup);
+        cgroup.clear();
+        // runOnce вызывается на каждый замер и тест — предупреждаем один раз
+        static std::atomic<bool> warned{false};
+        if (controls && arguments.memoryLimitMb && !warned.exchange(true))
+            logMessage(WARN, "memory.max недоступен — -mem-limit ограничит адресное пространство (RLIMIT_AS)", true);
+    }
+
+    int gate = -1;
+    pid_t pid = spawnGated(cmd, environment, setup, gate);
+    if (nul >= 0) close(nul);
+    if (setup.stdinFd >= 0) close(setup.stdinFd);
+    if (out >= 0) close(out);
+    if (pid < 0) {
+        removeRunCgroup(cgroup);
+        return stats;
+    }
+    // ребёнок ещё стоит у gate: без cgroup он остался бы совсем без лимита памяти
+    if (memoryLimited && !attachToCgroup(cgroup, pid)) {
+        kill(pid, SIGKILL);
+        while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {}
+        close(gate);
+        removeRunCgroup(cgroup);
+        return stats;
+    }
+
+    // отсчёт с момента, когда ребёнок отпущен: fork и подготовка в замер не входят
+    auto start = std::chrono::steady_clock::now();
+    close(gate);
+    std::atomic<bool> expired{false};
+    std::thread deadline = controls ? startDeadline(pid, cgroup, expired) : std::thread();
+    int status = 0;
+    struct rusage usage {};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+    if (deadline.joinable()) deadline.join();
+    stats.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    stats.code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    stats.userMs = usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0;
+    stats.systemMs = usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+    stats.maxRssKb = static_cast<unsigned long long>(usage.ru_maxrss);
+    bool oom = memoryLimited && cgroupOomKills(cgroup) > 0;
+    stats.stopReason = describeStop(status, expired, oom, stats.userMs + stats.systemMs);
+    stats.timedOut = expired;
+    // без cgroup лимит — RLIMIT_AS: нехватка видна только как bad_alloc (SIGABRT) или обращение по NULL
+    stats.memoryExceeded = oom || (controls && !memoryLimited && arguments.memoryLimitMb && !expired && WIFSIGNALED(status) &&
+                                   (WTERMSIG(status) == SIGABRT || WTERMSIG(status) == SIGSEGV ||
+                                    WTERMSIG(status) == SIGBUS));
+    removeRunCgroup(cgroup);
+#endif
+    stats.ok = true;
+    return stats;
+}
+
+void setEnvVar(std::vector<string>& env, const string& key, const string& value, char append) {
+    for (auto& var : env) {
+        if (var.compare(0, key.size() + 1, key + "=") != 0) continue;
+        if (append && var.size() > key.size() + 1) var += append + value;
+        else var = key + "=" + value;
+        return;
+    }
+    env.push_back(key + "=" + value);
+}
+
+int runScript(const string& cmd, bool monitoring, HistoryEntry* record) {
     MonitoringResult result{};
+    PerfResult perf{};
+    HeapResult heap{};
+    LockResult locks{};
+    SyscallResult syscalls{};
+    OutputStats output;
+    bool profiling = false, heapProfiling = false, lockProfiling = false, tracing = false, capturing = false;
     auto start = std::chrono::steady_clock::now();
     int code = -1;
+    string stopReason;
 
 #ifdef _WIN32
     STARTUPINFOA si{};
     si.cb = sizeof(si);
     PROCESS_INFORMATION pi{};
 
-    if (CreateProcessA(NULL, const_cast<char*>(cmd.c_str()), NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi)) {
+    if (monitoring && (arguments.perf || arguments.topDown)) logMessage(WARN, "Счётчики perf доступны только в Linux");
+    if (monitoring && arguments.profile) logMessage(WARN, "Профилирование доступно только в Linux");
+    if (monitoring && arguments.heap) logMessage(WARN, "Профиль кучи (LD_PRELOAD) доступен только в Linux");
+    if (monitoring && arguments.locks) logMessage(WARN, "Профиль блокировок (LD_PRELOAD) доступен только в Linux");
+    if (monitoring && arguments.syscalls) logMessage(WARN, "Трассировка системных вызовов доступна только в Linux");
+    if (!arguments.stdoutMode.empty()) logMessage(WARN, "Режимы -stdout доступны только в Linux");
+
+    HANDLE input = openInputHandle();
+    if (input != INVALID_HANDLE_VALUE) {
+        si.dwFlags = STARTF_USESTDHANDLES;
+        si.hStdInput = input;
+        si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+        si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    }
+    start = std::chrono::steady_clock::now();
+    BOOL started = CreateProcessA(NULL, const_cast<char*>(cmd.c_str()), NULL, NULL, input != INVALID_HANDLE_VALUE, 0,
+                                  NULL, NULL, &si, &pi);
+    if (input != INVALID_HANDLE_VALUE) CloseHandle(input);
+    if (started) {
         if (monitoring) monitorProcess(pi.dwProcessId, result);
 
-        WaitForSingleObject(pi.hProcess, INFINITE);
+        if (waitWithDeadline(pi.hProcess)) stopReason = "превышен лимит времени " + fixed2(arguments.timeout) + " s";
+        if (monitoring) shutdownMonitor();
         GetExitCodeProcess(pi.hProcess, (LPDWORD)&code);
         CloseHandle(pi.hProcess);
         CloseHandle(pi.hThread);
@@ -45,42 +703,150 @@ int runScript(const string& cmd, bool monitoring) {
     }
 
 #else  // Linux / macOS
-    pid_t pid = fork();
-    if (pid == 0) {
-        execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)nullptr);
-        _exit(127);  // если exec не сработал
+    std::vector<string> env = currentEnvironment();
+    heapProfiling = monitoring && arguments.heap && prepareHeapProfiler(env);
+    lockProfiling = monitoring && arguments.locks && prepareLockProfiler(env);
+
+    // отдельная cgroup нужна, чтобы учитывать всё дерево процессов, а не только /bin/sh
+    string cgroup = monitoring ? createRunCgroup() : "";
+
+    // дочерний процесс ждёт, пока родитель не закончит подготовку (cgroup и т.п.)
+    int gate = -1;
+    ChildSetup setup;
+    applyRunControls(setup);
+    // RSS ограничивает memory.max cgroup; RLIMIT_AS остаётся только при явном -as-limit
+    bool memoryLimited = false;
+    if (arguments.memoryLimitMb && (memoryLimited = limitRunCgroup(cgroup, arguments.memoryLimitMb * 1024 * 1024)))
+        setup.addressSpace = arguments.addressLimitMb * 1024 * 1024;
+    else if (arguments.memoryLimitMb)
+        logMessage(WARN, "memory.max недоступен — -mem-limit ограничит адресное пространство (RLIMIT_AS)", true);
+    setup.stdinFd = openRunInput();
+    setup.stdoutFd = openOutputCapture();
+    capturing = setup.stdoutFd >= 0;
+    if (!arguments.stderrFile.empty())
+        setup.stderrFd = open(arguments.stderrFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    pid_t pid = spawnGated(cmd, env, setup, gate);
+    if (setup.stdinFd >= 0) close(setup.stdinFd);
+    if (setup.stderrFd >= 0) close(setup.stderrFd);
+    if (pid < 0) {
+        logMessage(FAULT, "Не удалось запустить процесс: " + cmd);
+        if (capturing) finishOutputCapture(output);
+        removeRunCgroup(cgroup);
+        return -1;
     }
-    else if (pid > 0) {
-        if (monitoring) monitorProcess(pid, result);
-        int status = 0;
-        waitpid(pid, &status, 0);
-        if (WIFEXITED(status)) code = WEXITSTATUS(status);
-        else code = -1;
+    if (capturing) startOutputCapture();
+
+    if (!cgroup.empty() && !attachToCgroup(cgroup, pid)) {
+        removeRunCgroup(cgroup);
+        cgroup.clear();
     }
+    if (monitoring) monitorProcess(pid, result, cgroup);
+    // счётчики включатся сами на exec (enable_on_exec)
+    bool counting = monitoring && (arguments.perf || arguments.topDown) &&
+                    openPerfCounters(pid, arguments.perf, arguments.topDown);
+    // трассировщик подключается первым: ptrace-режим профилировщика с ним несовместим
+    tracing = monitoring && arguments.syscalls && startSyscallTrace(pid, arguments.syscalls);
+    profiling = monitoring && arguments.profile && startProfiler(pid);
+    // как в runOnce: сборка crun_heap.so / crun_locks.so, perf и ptrace — подготовка, а не время программы
+    start = std::chrono::steady_clock::now();
+    close(gate);
+    std::atomic<bool> expired{false};
+    std::thread deadline = startDeadline(pid, cgroup, expired);
+
+    // ждём без освобождения зомби, чтобы монитор успел снять последний замер
+    if (tracing) waitSyscallTraced(pid);
+    else if (profiling) waitProfiled(pid);
     else {
-        logMessage(FAULT, "Не удалось запустить процесс: " + cmd);
-        return -1;
+        siginfo_t info{};
+        while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) != 0 && errno == EINTR) {}
     }
+    if (deadline.joinable()) deadline.join();
+    if (monitoring) shutdownMonitor();
+    if (counting) readPerfCounters(perf);
+
+    int status = reapProcess(pid, monitoring ? &result : nullptr);
+    if (WIFEXITED(status)) code = WEXITSTATUS(status);
+    else code = -1;
+    bool oom = memoryLimited && cgroupOomKills(cgroup) > 0;
+    stopReason = describeStop(status, expired, oom,
+                              monitoring ? static_cast<double>(result.cpuUserMs + result.cpuSystemMs) : 0);
+
+    removeRunCgroup(cgroup);
 #endif
 
     auto end = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+#ifndef _WIN32
+    if (capturing) finishOutputCapture(output);
+    if (!arguments.stderrFile.empty()) printFile(arguments.stderrFile, stderr);
+#endif
 
     logMessageA(INFO, "", true);
+    if (!output.tail.empty()) {
+        logMessage(INFO, "Последние строки вывода (" + std::to_string(arguments.stdoutTail) + "):", true);
+        fwrite(output.tail.data(), 1, output.tail.size(), stdout);
+        if (output.tail.back() != '\n') fputc('\n', stdout);
+        fflush(stdout);
+    }
+    if (!stopReason.empty()) logMessage(FAULT, "Программа остановлена: " + stopReason);
 
     if (monitoring) {
         logMessage(INFO, "Результаты мониторинга:", true);
         logMessageA(INFO, "    Время выполнения: " + std::to_string(duration) + " ms", true);
+        printPerf(perf, duration);
+        logMessageA(INFO, "    CPU user:    " + std::to_string(result.cpuUserMs) + " ms", true);
+        logMessageA(INFO, "    CPU system:  " + std::to_string(result.cpuSystemMs) + " ms", true);
         logMessageA(INFO, "    CPU max:     " + std::to_string(result.cpuMax) + "%", true);
         logMessageA(INFO, "    CPU average: " + std::to_string(result.cpuAverage) + "%", true);
         logMessageA(INFO, "    RAM max:     " + std::to_string(result.ramMax) + " MB", true);
         logMessageA(INFO, "    RAM average: " + std::to_string(result.ramAverage) + " MB", true);
+        logMessageA(INFO, "    Процессов:   " + std::to_string(result.processesMax), true);
+        logMessageA(INFO, string("    Источник:    ") + (result.cgroup ? "cgroup v2" : "/proc"), true);
+        printPeakMemory(result);
+        printIo(result, duration);
+        if (capturing) printOutput(output, duration);
+        printThreads(result);
+        printSched(result.sched);
+
+        if (record) {
+            record->kind = "run";
+            record->code = code;
+            record->wallMs = static_cast<double>(duration);
+            record->userMs = static_cast<double>(result.cpuUserMs);
+            record->systemMs = static_cast<double>(result.cpuSystemMs);
+            record->maxRssKb = std::max(result.ramMax * 1024ULL, result.peakMemory.rss);
+            if (perf.instructions.ok && perf.cycles.ok) {
+                record->instructions = perf.instructions.value;
+                record->cycles = perf.cycles.value;
+            }
+        }
     }
+#ifndef _WIN32
+    if (tracing) {
+        finishSyscallTrace(syscalls);
+        printSyscalls(syscalls);
+    }
+#endif
+
+#ifndef _WIN32
+    // символизация после замера времени, чтобы не влиять на результаты
+    if (profiling) finishProfiler();
+    if (heapProfiling) {
+        collectHeapReport(heap);
+        printHeap(heap);
+    }
+    if (lockProfiling) {
+        collectLockReport(locks);
+        printLocks(locks);
+    }
+#endif
 
     return code;
 }
 
-void run() {
+int run() {
+    // stress собирает три программы по отдельности; имя — по решению
+    if (!arguments.stress.empty() && arguments.name.empty()) arguments.name = fs::path(arguments.stress[2]).stem().string();
     if (arguments.name.empty()) {
         if (arguments.files.empty()) {
             arguments.files.insert(arguments.downToC ? "main.c" : "main.cpp");
@@ -136,31 +902,157 @@ void run() {
     string libsStr;
     for (auto& lib : arguments.libsList) libsStr += " -l" + lib;
 
-    if (arguments.launch != RUN) {
+    // frame pointer нужен для раскрутки стеков профилировщиком
+    string options = arguments.compilerOptions;
+    if (arguments.profile) options += " -fno-omit-frame-pointer -g";
+
+    auto compile = [&](const fs::path& output, const string& flags, const string& files) {
         std::ostringstream ss;
-        ss << compiler << filesStr << libDirStr << includeStr << libsStr << " " << arguments.compilerOptions << " -o \""
-           << outputPath.string() << "\" -finput-charset=UTF-8";
+        ss << compiler << files << libDirStr << includeStr << libsStr << " " << flags << " -o \""
+           << output.string() << "\" -finput-charset=UTF-8";
+        return system(ss.str().c_str()) == 0;
+    };
+
+    // отдельная программа из одного файла (stress, чекер); команда запуска или пусто при ошибке
+    auto buildSingle = [&](const string& source) -> string {
+        fs::path exe = fs::absolute(fs::path(arguments.buildFolder) / fs::path(source).stem());
+#ifdef _WIN32
+        exe += ".exe";
+#endif
+        if (arguments.launch != RUN) {
+            logMessage(INFO, "Начало сборки " + source, true, "⚒️");
+            if (!compile(exe, options, " \"" + source + "\"")) {
+                logMessage(FAULT, "Ошибка при компиляции " + source + "!");
+                return "";
+            }
+        }
+        if (!fs::exists(exe)) {
+            logMessage(FAULT, "Исполняемый файл не найден: " + exe.string(), true, "❓");
+            return "";
+        }
+        return "\"" + exe.string() + "\"";
+    };
+
+    // чекер: исходник собирается рядом с программой, готовый файл запускается как есть
+    string checkerCmd;
+    if (!arguments.checker.empty() && (!arguments.stress.empty() || !arguments.judgeDir.empty())) {
+        string ext = fs::path(arguments.checker).extension().string();
+        if (ext == ".cpp" || ext == ".cc" || ext == ".c") checkerCmd = buildSingle(arguments.checker);
+        else if (fs::exists(arguments.checker)) checkerCmd = "\"" + fs::absolute(arguments.checker).string() + "\"";
+        if (checkerCmd.empty()) {
+            logMessage(FAULT, "Чекер недоступен: " + arguments.checker, true, "❓");
+            return 1;
+        }
+    }
+
+    // stress: генератор, эталон и решение — отдельные программы из одного файла каждая
+    if (!arguments.stress.empty()) {
+        std::vector<string> commands;
+        for (auto& source : arguments.stress) {
+            commands.push_back(buildSingle(source));
+            if (commands.back().empty()) return 1;
+        }
+        if (arguments.launch == BUILD) return 0;
+        checkRunNoise();
+        return runStress(commands[0], commands[1], commands[2], checkerCmd);
+    }
+
+    // A/B: вариант B — другие опции (вторая сборка рядом), другой файл или сохранённый baseline
+    fs::path baselinePath = outputPath;
+    baselinePath += ".baseline";
+    fs::path comparePath;
+    if (arguments.compareBuild) comparePath = fs::path(outputPath.parent_path() / (arguments.name + "_b"));
+    else if (arguments.compareWith == "baseline") comparePath = baselinePath;
+    else if (!arguments.compareWith.empty()) comparePath = fs::absolute(arguments.compareWith);
+#ifdef _WIN32
+    if (arguments.compareBuild) comparePath += ".exe";
+#endif
+
+    if (arguments.launch != RUN) {
         logMessage(INFO, "Начало сборки " + arguments.name, true, "⚒️");
-        if (system(ss.str().c_str()) != 0) {
+        if (!compile(outputPath, options, filesStr)) {
             logMessage(FAULT, "Ошибка при компиляции!");
-            return;
+            return 1;
+        }
+        if (arguments.compareBuild) {
+            string compareFlags = arguments.compareOptions;
+            if (arguments.profile) compareFlags += " -fno-omit-frame-pointer -g";
+            logMessage(INFO, "Сборка варианта B: " + compareFlags, true, "⚒️");
+            if (!compile(comparePath, compareFlags, filesStr)) {
+                logMessage(FAULT, "Ошибка при компиляции варианта B!");
+                return 1;
+            }
         }
         logMessage(INFO, "Сборка завершена", true, "✅");
     }
 
+    if (arguments.saveBaseline && fs::exists(outputPath)) {
+        std::error_code ec;
+        fs::copy_file(outputPath, baselinePath, fs::copy_options::overwrite_existing, ec);
+        if (ec) logMessage(WARN, "Не удалось сохранить baseline: " + ec.message());
+        else logMessage(INFO, "Baseline сохранён: " + baselinePath.string(), true, "💾");
+    }
+
     if (arguments.launch != BUILD) {
         if (!fs::exists(outputPath)) {
             logMessage(FAULT, "Исполняемый файл не найден!", true, "❓");
-            return;
+            return 1;
+        }
+
+        if (!arguments.stdinFile.empty() && !fs::exists(arguments.stdinFile)) {
+            logMessage(FAULT, "Файл для stdin не найден: " + arguments.stdinFile, true, "❓");
+            return 1;
         }
 
         string cmd = "\"" + outputPath.string() + "\" " + arguments.exeArgs;
+        checkRunNoise();
         logMessage(INFO, "Запуск программы", true, "➡️");
         logMessageA(INFO, "", true);
 
-        int ret = runScript(cmd, true);
+        int ret;
+        if (!comparePath.empty()) {
+            if (!fs::exists(comparePath)) {
+                logMessage(FAULT, "Вариант B не найден: " + comparePath.string(), true, "❓");
+                return 1;
+            }
+            if (!arguments.bench) arguments.bench = 10;
+            string compareCmd = "\"" + comparePath.string() + "\" " + arguments.exeArgs;
+            string labelB = arguments.compareBuild ? "опции " + arguments.compareOptions
+                            : arguments.compareWith == "baseline" ? "baseline" : comparePath.filename().string();
+            string labelA = !arguments.compareBuild ? "текущая сборка" : options.empty() ? "без опций" : "опции " + options;
+            ret = runComparison(cmd, labelA, compareCmd, labelB);
+        }
+        else if (!arguments.judgeDir.empty()) ret = runJudge(cmd, checkerCmd);
+        else if (arguments.matrixRun) ret = runMatrix(cmd);
+        else if (arguments.load) ret = runLoad(cmd);
+        else if (arguments.scaleRun) ret = runScaling(cmd);
+        else {
+            // каждый замер попадает в .crun/history.jsonl; порог сравнивается до записи нового
+            HistoryEntry record;
+            record.name = arguments.name;
+            record.options = options;
+            record.args = arguments.exeArgs;
+            record.setup = runSetup();
+            // повтор из кэша не замер: в историю не попадает
+            string cacheKey = arguments.cache && !arguments.bench ? runCacheKey(outputPath.string()) : "";
+            if (arguments.bench) ret = runBenchmark(cmd, &record);
+            else if (cacheKey.empty() || !replayRun(cacheKey, ret)) {
+                if (!cacheKey.empty()) prepareRunCache(cacheKey);
+                ret = runScript(cmd, true, &record);
+                if (!cacheKey.empty()) storeRunCache(cacheKey, ret);
+            }
+            if (!record.kind.empty()) {
+                if (ret == 0 && arguments.failIfSlower > 0 && slowerThanHistory(record, arguments.failIfSlower)) {
+                    appendHistory(record);
+                    return 1;
+                }
+                appendHistory(record);
+            }
+        }
 
         if (ret != 0) logMessage(FAULT, "Завершена с ошибкой (" + std::to_string(ret) + ")");
         else logMessage(INFO, "Успешное завершение", true, "⏹️");
+        return ret;
     }
+    return 0;
 }
@@ -0,0 +1,140 @@
+#include "../scale.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../runner.hpp"
+#include "../stats.hpp"
+#include "../tuning.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+struct ScalePoint {
+    unsigned threads = 0;
+    Summary wall;
+    double cpuMs = 0;        // user + system, медиана
+    double speedup = 0;      // T(1) / T(p)
+    double efficiency = 0;   // speedup / p
+    double serial = 0;       // Карп–Флатт: (1/S - 1/p) / (1 - 1/p), только при p > 1
+    bool ok = false;
+};
+
+// private: до 8 ядер — каждое число потоков, дальше степени двойки и само число ядер
+static std::vector<unsigned> threadCounts(unsigned cores) {
+    std::vector<unsigned> counts;
+    if (cores <= 8)
+        for (unsigned p = 1; p <= cores; ++p) counts.push_back(p);
+    else {
+        for (unsigned p = 1; p < cores; p *= 2) counts.push_back(p);
+        counts.push_back(cores);
+    }
+    return counts;
+}
+
+// private: команда с подставленным числом потоков вместо {threads}
+static string withThreads(const string& cmd, unsigned threads) {
+    string result = cmd;
+    for (size_t pos = 0; (pos = result.find("{threads}", pos)) != string::npos;)
+        result.replace(pos, 9, std::to_string(threads));
+    return result;
+}
+
+// private
+static bool writeCsv(const fs::path& path, const std::vector<ScalePoint>& points) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "threads,wall_ms,wall_stddev_ms,cpu_ms,speedup,efficiency,karp_flatt\n";
+    for (auto& p : points) {
+        if (!p.ok) continue;
+        out << p.threads << ',' << fixed2(p.wall.median) << ',' << fixed2(p.wall.stddev) << ',' << fixed2(p.cpuMs)
+            << ',' << fixed2(p.speedup) << ',' << fixed2(p.efficiency) << ',';
+        if (p.threads > 1) out << fixed2(p.serial);
+        out << '\n';
+    }
+    return true;
+}
+
+int runScaling(const string& cmd) {
+    bool placeholder = cmd.find("{threads}") != string::npos;
+    unsigned cores = static_cast<unsigned>(std::max<size_t>(1, runCpus().size()));
+    unsigned maxThreads = arguments.scaleMax ? arguments.scaleMax : cores;
+    unsigned runs = arguments.bench ? arguments.bench : 3;
+    std::vector<unsigned> counts = threadCounts(maxThreads);
+
+    logMessage(INFO, "Масштабирование: " + std::to_string(counts.size()) + " точек до " + std::to_string(maxThreads) +
+                         " потоков, по " + std::to_string(runs) + " запуска, потоки через " +
+                         (placeholder ? string("{threads}") : arguments.threadsVar), true, "📐");
+    if (maxThreads > cores)
+        logMessage(WARN, "Потоков больше, чем ядер (" + std::to_string(cores) + "): дальше ускорения не будет", true);
+
+    // прогрев на одном потоке: страничный кэш и частота
+    std::vector<string> env{arguments.threadsVar + "=1"};
+    for (unsigned i = 0; i < arguments.warmup; ++i) runOnce(withThreads(cmd, 1), true, env);
+
+    std::vector<ScalePoint> points;
+    for (unsigned threads : counts) {
+        ScalePoint point;
+        point.threads = threads;
+        env = {arguments.threadsVar + "=" + std::to_string(threads)};
+        std::vector<double> wall, cpu;
+        for (unsigned i = 0; i < runs; ++i) {
+            RunStats r = runOnce(withThreads(cmd, threads), true, env);
+            if (!r.ok || r.code != 0) {
+                logMessage(FAULT, "Запуск на " + std::to_string(threads) + " потоках завершился с кодом " +
+                                      std::to_string(r.code));
+                return r.ok ? r.code : -1;
+            }
+            wall.push_back(r.wallMs);
+            cpu.push_back(r.userMs + r.systemMs);
+        }
+        point.wall = summarize(wall);
+        point.cpuMs = summarize(cpu).median;
+        point.ok = true;
+        logMessageA(INFO, "    " + std::to_string(threads) + " → " + fixed2(point.wall.median) + " ms", true);
+        points.push_back(point);
+    }
+
+    // медиана устойчивее среднего к единичным задержкам
+    double base = points.front().wall.median;
+    for (auto& p : points) {
+        p.speedup = p.wall.median > 0 ? base / p.wall.median : 0;
+        p.efficiency = p.speedup / p.threads;
+        if (p.threads > 1 && p.speedup > 0) p.serial = (1 / p.speedup - 1.0 / p.threads) / (1 - 1.0 / p.threads);
+    }
+
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты масштабирования:", true);
+    logMessageA(INFO, "    потоки  wall, ms            CPU, ms     ускорение  эффективность  Карп–Флатт", true);
+    for (auto& p : points) {
+        char row[160];
+        snprintf(row, sizeof(row), "    %-7u %9.2f ± %-7.2f %9.2f   %8.2f×  %11.0f%%    ", p.threads, p.wall.median,
+                 p.wall.stddev, p.cpuMs, p.speedup, p.efficiency * 100);
+        logMessageA(INFO, string(row) + (p.threads > 1 ? fixed2(p.serial) : "-"), true);
+    }
+
+    // где параллельность перестаёт окупаться
+    auto best = std::max_element(points.begin(), points.end(),
+                                 [](const ScalePoint& a, const ScalePoint& b) { return a.speedup < b.speedup; });
+    logMessage(INFO, "Лучшее ускорение " + fixed2(best->speedup) + "× на " + std::to_string(best->threads) + " потоках",
+               true, "🏁");
+    for (auto& p : points)
+        if (p.threads > 1 && p.efficiency < 0.5) {
+            logMessage(WARN, "С " + std::to_string(p.threads) + " потоков эффективность ниже 50%", true);
+            break;
+        }
+    // растущая доля Карпа–Флатта — накладные расходы (синхронизация, память), а не последовательная часть
+    if (points.size() >= 3 && points.back().serial > points[1].serial * 1.5 && points.back().serial > 0.05)
+        logMessage(WARN, "Доля Карпа–Флатта растёт с числом потоков: мешают синхронизация или память, а не "
+                         "последовательный код", true);
+
+    fs::path output = fs::path(arguments.buildFolder) / (arguments.name + ".scale.csv");
+    if (writeCsv(output, points)) logMessage(INFO, "Таблица сохранена: " + output.string(), true, "💾");
+    else logMessage(WARN, "Не удалось записать " + output.string());
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "../stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+// private: квантиль с линейной интерполяцией по отсортированной выборке
+static double quantile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    double pos = q * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    if (lo + 1 >= sorted.size()) return sorted.back();
+    return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+Summary summarize(std::vector<double> values) {
+    Summary s;
+    s.n = values.size();
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+
+    double sum = 0;
+    for (double v : values) sum += v;
+    s.mean = sum / s.n;
+    double squares = 0;
+    for (double v : values) squares += (v - s.mean) * (v - s.mean);
+    s.stddev = s.n > 1 ? std::sqrt(squares / (s.n - 1)) : 0;
+
+    s.min = values.front();
+    s.max = values.back();
+    s.median = quantile(values, 0.5);
+    s.q1 = quantile(values, 0.25);
+    s.q3 = quantile(values, 0.75);
+    s.p90 = quantile(values, 0.9);
+    s.p99 = quantile(values, 0.99);
+
+    double iqr = s.q3 - s.q1;
+    for (double v : values) {
+        if (v < s.q1 - 3 * iqr || v > s.q3 + 3 * iqr) ++s.severeOutliers;
+        else if (v < s.q1 - 1.5 * iqr || v > s.q3 + 1.5 * iqr) ++s.outliers;
+    }
+    s.outliers += s.severeOutliers;
+    return s;
+}
+
+double mannWhitneyP(const std::vector<double>& a, const std::vector<double>& b, double* u) {
+    size_t n1 = a.size(), n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1;
+
+    // общие ранги; у равных значений — средний ранг
+    std::vector<std::pair<double, int>> all;
+    for (double v : a) all.push_back({v, 0});
+    for (double v : b) all.push_back({v, 1});
+    std::sort(all.begin(), all.end());
+    double rankSumA = 0, ties = 0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+        double rank = (i + j + 1) / 2.0;  // ранги i+1 … j
+        for (size_t k = i; k < j; ++k)
+            if (all[k].second == 0) rankSumA += rank;
+        double t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double u1 = rankSumA - n1 * (n1 + 1) / 2.0;
+    if (u) *u = std::min(u1, n1 * n2 - u1);
+    double n = static_cast<double>(n1 + n2);
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)));
+    if (variance <= 0) return 1;
+    double z = (std::fabs(u1 - mean) - 0.5) / std::sqrt(variance);
+    if (z < 0) z = 0;
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+Interval bootstrapRatio(const std::vector<double>& a, const std::vector<double>& b, double level) {
+    Interval interval;
+    if (a.empty() || b.empty()) return interval;
+    const int ITERATIONS = 5000;
+    // фиксированное зерно: один и тот же набор замеров всегда даёт тот же интервал
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<size_t> pickA(0, a.size() - 1), pickB(0, b.size() - 1);
+
+    std::vector<double> ratios;
+    ratios.reserve(ITERATIONS);
+    for (int it = 0; it < ITERATIONS; ++it) {
+        double sumA = 0, sumB = 0;
+        for (size_t i = 0; i < a.size(); ++i) sumA += a[pickA(rng)];
+        for (size_t i = 0; i < b.size(); ++i) sumB += b[pickB(rng)];
+        if (sumA > 0) ratios.push_back((sumB / b.size()) / (sumA / a.size()));
+    }
+    std::sort(ratios.begin(), ratios.end());
+    interval.low = quantile(ratios, (1 - level) / 2);
+    interval.high = quantile(ratios, 1 - (1 - level) / 2);
+    return interval;
+}
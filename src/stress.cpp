@@ -0,0 +1,173 @@
+#include "../stress.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../args.hpp"
+#include "../checker.hpp"
+#include "../compare.hpp"
+#include "../logger.hpp"
+#include "../runner.hpp"
+#include "../tuning.hpp"
+
+namespace fs = std::filesystem;
+using std::string;
+
+// итоги одного потока: складываются после остановки
+struct StressTotals {
+    unsigned long long iterations = 0;
+    double generatorMs = 0, referenceMs = 0, solutionMs = 0;
+};
+
+// первое найденное расхождение
+struct StressFailure {
+    unsigned long long seed = 0;
+    string reason;
+    fs::path input, answer, output;
+};
+
+// private: почему запуск не считается успешным; пусто — успешен
+static string runFailure(const RunStats& r) {
+    if (!r.ok) return "не удалось запустить";
+    if (!r.stopReason.empty()) return r.stopReason;
+    if (r.code != 0) return "код " + std::to_string(r.code);
+    return "";
+}
+
+int runStress(const string& generator, const string& reference, const string& solution, const string& checker) {
+    // без лимита зависшее решение остановило бы весь прогон
+    if (arguments.timeout <= 0) arguments.timeout = 10;
+    std::vector<int> cpus = runCpus();
+    unsigned parallel = static_cast<unsigned>(std::max<size_t>(1, cpus.size()));
+    fs::path workDir = fs::path(arguments.buildFolder) / (arguments.name + ".stress");
+    std::error_code ec;
+    fs::create_directories(workDir, ec);
+
+    logMessage(INFO, "Стресс-тест: " + std::to_string(parallel) + " потоков, " +
+                         (arguments.stressLimit ? "до " + std::to_string(arguments.stressLimit) + " итераций"
+                                                : string("до первого расхождения")) +
+                         ", сравнение " + (checker.empty() ? arguments.compare : "чекером"), true, "🔥");
+
+    std::atomic<unsigned long long> nextSeed{1};
+    std::atomic<unsigned long long> done{0};
+    std::atomic<bool> stop{false};
+    std::mutex failureLock;
+    bool failed = false;
+    StressFailure failure;
+    std::vector<StressTotals> totals(parallel);
+
+    // у каждого потока свои файлы: вход генератора, ответ эталона, вывод решения
+    auto worker = [&](unsigned index) {
+        std::vector<int> own;
+        if (parallel > 1) own.push_back(cpus[index]);
+        string prefix = (workDir / std::to_string(index)).string();
+        string input = prefix + ".in", answer = prefix + ".ans", output = prefix + ".out";
+        StressTotals& t = totals[index];
+        while (!stop) {
+            unsigned long long seed = nextSeed++;
+            if (arguments.stressLimit && seed > arguments.stressLimit) break;
+            string reason;
+            RunStats r = runOnce(generator + " " + std::to_string(seed) + " " + arguments.exeArgs, true, {}, own, "",
+                                 input);
+            t.generatorMs += r.wallMs;
+            if (!(reason = runFailure(r)).empty()) reason = "генератор: " + reason;
+            if (reason.empty()) {
+                r = runOnce(reference, true, {}, own, input, answer);
+                t.referenceMs += r.wallMs;
+                if (!(reason = runFailure(r)).empty()) reason = "эталон: " + reason;
+            }
+            if (reason.empty()) {
+                r = runOnce(solution, true, {}, own, input, output);
+                t.solutionMs += r.wallMs;
+                if (!(reason = runFailure(r)).empty()) reason = "решение: " + reason;
+            }
+            if (reason.empty() && checker.empty()) {
+                CompareResult result = compareFiles(answer, output);
+                if (!result.same) reason = "выводы расходятся, " + result.difference;
+            }
+            else if (reason.empty()) {
+                CheckResult result = runChecker(checker, input, answer, output);
+                if (result.verdict != "OK")
+                    reason = "чекер: " + result.verdict + (result.comment.empty() ? "" : ", " + result.comment);
+            }
+            ++t.iterations;
+            ++done;
+            if (reason.empty()) continue;
+
+            std::lock_guard<std::mutex> lock(failureLock);
+            // среди одновременно найденных оставляем меньший seed — его проще воспроизвести
+            if (!failed || seed < failure.seed) {
+                failed = true;
+                failure.seed = seed;
+                failure.reason = reason;
+                fs::path base = fs::path(arguments.buildFolder) / arguments.name;
+                failure.input = base.string() + ".stress.in";
+                failure.answer = base.string() + ".stress.ans";
+                failure.output = base.string() + ".stress.out";
+                fs::copy_file(input, failure.input, fs::copy_options::overwrite_existing, ec);
+                fs::copy_file(answer, failure.answer, fs::copy_options::overwrite_existing, ec);
+                fs::copy_file(output, failure.output, fs::copy_options::overwrite_existing, ec);
+            }
+            stop = true;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < parallel; ++i) threads.emplace_back(worker, i);
+
+    // прогресс раз в 5 секунд, пока потоки работают
+    std::mutex waitLock;
+    std::condition_variable finished;
+    bool allDone = false;
+    std::thread progress([&]() {
+        std::unique_lock<std::mutex> lock(waitLock);
+        while (!finished.wait_for(lock, std::chrono::seconds(5), [&]() { return allDone; }))
+            logMessageA(INFO, "    " + std::to_string(done.load()) + " итераций, " +
+                                  fixed2(done * 1000.0 / elapsedMs()) + "/с", true);
+    });
+    for (auto& t : threads) t.join();
+    double totalMs = elapsedMs();
+    {
+        std::lock_guard<std::mutex> lock(waitLock);
+        allDone = true;
+    }
+    finished.notify_one();
+    progress.join();
+
+    StressTotals sum;
+    for (auto& t : totals) {
+        sum.iterations += t.iterations;
+        sum.generatorMs += t.generatorMs;
+        sum.referenceMs += t.referenceMs;
+        sum.solutionMs += t.solutionMs;
+    }
+    double n = sum.iterations ? static_cast<double>(sum.iterations) : 1;
+
+    logMessageA(INFO, "", true);
+    logMessage(INFO, "Результаты стресс-теста:", true);
+    logMessageA(INFO, "    Итераций:    " + std::to_string(sum.iterations) + " за " + fixed2(totalMs / 1000) + " s, " +
+                          fixed2(totalMs > 0 ? sum.iterations * 1000.0 / totalMs : 0) + "/с", true);
+    logMessageA(INFO, "    В среднем:   генератор " + fixed2(sum.generatorMs / n) + " ms, эталон " +
+                          fixed2(sum.referenceMs / n) + " ms, решение " + fixed2(sum.solutionMs / n) + " ms", true);
+
+    if (!failed) {
+        logMessage(INFO, "Расхождений не найдено", true, "✅");
+        return 0;
+    }
+    logMessage(FAULT, "Seed " + std::to_string(failure.seed) + ": " + failure.reason);
+    logMessageA(INFO, "    Вход:        " + failure.input.string(), true);
+    logMessageA(INFO, "    Эталон:      " + failure.answer.string(), true);
+    logMessageA(INFO, "    Решение:     " + failure.output.string(), true);
+    return 1;
+}
@@ -0,0 +1,766 @@
+#include "../syscalls.hpp"
+
+#ifndef _WIN32
+#include <linux/audit.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <ctime>
+#include <set>
+#include <unordered_map>
+
+#include "../logger.hpp"
+
+using std::string;
+
+// старые glibc не дают имени полю sigevent для SIGEV_THREAD_ID
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+// вызовы чужой архитектуры (32-битные на x86_64) нумеруются по своей таблице — в stats они с этим флагом
+static const uint64_t COMPAT = 1ULL << 63;
+#if defined(__x86_64__)
+static const uint32_t NATIVE_ARCH = AUDIT_ARCH_X86_64;
+#elif defined(__aarch64__)
+static const uint32_t NATIVE_ARCH = AUDIT_ARCH_AARCH64;
+#else
+static const uint32_t NATIVE_ARCH = 0;  // неизвестна: все вызовы считаются родными
+#endif
+
+static const unsigned WINDOW_MS = 1000;  // в режиме сэмплирования: percent% каждого такого окна
+static const unsigned TICK_MS = 10;      // шаг проверки окна (таймер прерывает waitid)
+
+// Раскладка struct ptrace_syscall_info из <linux/ptrace.h>, который конфликтует с <sys/ptrace.h>
+struct SyscallInfo {
+    uint8_t op;  // 1 — вход, 2 — выход
+    uint8_t pad[3];
+    uint32_t arch;
+    uint64_t instructionPointer;
+    uint64_t stackPointer;
+    union {
+        struct {
+            uint64_t nr;
+            uint64_t args[6];
+        } entry;
+        struct {
+            int64_t rval;
+            uint8_t isError;
+        } exit;
+        uint64_t raw[8];
+    };
+};
+
+struct InFlight {
+    uint64_t nr;
+    std::chrono::steady_clock::time_point start;
+};
+
+static std::set<pid_t> tracees;
+static std::set<pid_t> interrupted;
+static std::unordered_map<pid_t, InFlight> inFlight;
+static std::unordered_map<uint64_t, SyscallStat> stats;
+static unsigned percent = 100;
+static bool tracing = true;  // сейчас окно трассировки
+static bool infoMissing = false;  // PTRACE_GET_SYSCALL_INFO не работает — таблицы не будет
+static std::chrono::steady_clock::time_point started, windowStart;
+static std::chrono::steady_clock::duration traced{};
+static timer_t ticker;
+static bool tickerArmed = false;
+static struct sigaction previousAction {};
+
+static const std::unordered_map<uint64_t, const char*> NAMES = {
+#ifdef SYS_read
+    {SYS_read, "read"},
+#endif
+#ifdef SYS_write
+    {SYS_write, "write"},
+#endif
+#ifdef SYS_open
+    {SYS_open, "open"},
+#endif
+#ifdef SYS_close
+    {SYS_close, "close"},
+#endif
+#ifdef SYS_stat
+    {SYS_stat, "stat"},
+#endif
+#ifdef SYS_fstat
+    {SYS_fstat, "fstat"},
+#endif
+#ifdef SYS_lstat
+    {SYS_lstat, "lstat"},
+#endif
+#ifdef SYS_poll
+    {SYS_poll, "poll"},
+#endif
+#ifdef SYS_lseek
+    {SYS_lseek, "lseek"},
+#endif
+#ifdef SYS_mmap
+    {SYS_mmap, "mmap"},
+#endif
+#ifdef SYS_mprotect
+    {SYS_mprotect, "mprotect"},
+#endif
+#ifdef SYS_munmap
+    {SYS_munmap, "munmap"},
+#endif
+#ifdef SYS_brk
+    {SYS_brk, "brk"},
+#endif
+#ifdef SYS_rt_sigaction
+    {SYS_rt_sigaction, "rt_sigaction"},
+#endif
+#ifdef SYS_rt_sigprocmask
+    {SYS_rt_sigprocmask, "rt_sigprocmask"},
+#endif
+#ifdef SYS_rt_sigreturn
+    {SYS_rt_sigreturn, "rt_sigreturn"},
+#endif
+#ifdef SYS_restart_syscall
+    {SYS_restart_syscall, "restart_syscall"},
+#endif
+#ifdef SYS_ioctl
+    {SYS_ioctl, "ioctl"},
+#endif
+#ifdef SYS_pread64
+    {SYS_pread64, "pread64"},
+#endif
+#ifdef SYS_pwrite64
+    {SYS_pwrite64, "pwrite64"},
+#endif
+#ifdef SYS_readv
+    {SYS_readv, "readv"},
+#endif
+#ifdef SYS_writev
+    {SYS_writev, "writev"},
+#endif
+#ifdef SYS_access
+    {SYS_access, "access"},
+#endif
+#ifdef SYS_pipe
+    {SYS_pipe, "pipe"},
+#endif
+#ifdef SYS_select
+    {SYS_select, "select"},
+#endif
+#ifdef SYS_sched_yield
+    {SYS_sched_yield, "sched_yield"},
+#endif
+#ifdef SYS_mremap
+    {SYS_mremap, "mremap"},
+#endif
+#ifdef SYS_msync
+    {SYS_msync, "msync"},
+#endif
+#ifdef SYS_mincore
+    {SYS_mincore, "mincore"},
+#endif
+#ifdef SYS_madvise
+    {SYS_madvise, "madvise"},
+#endif
+#ifdef SYS_dup
+    {SYS_dup, "dup"},
+#endif
+#ifdef SYS_dup2
+    {SYS_dup2, "dup2"},
+#endif
+#ifdef SYS_pause
+    {SYS_pause, "pause"},
+#endif
+#ifdef SYS_nanosleep
+    {SYS_nanosleep, "nanosleep"},
+#endif
+#ifdef SYS_getitimer
+    {SYS_getitimer, "getitimer"},
+#endif
+#ifdef SYS_alarm
+    {SYS_alarm, "alarm"},
+#endif
+#ifdef SYS_setitimer
+    {SYS_setitimer, "setitimer"},
+#endif
+#ifdef SYS_getpid
+    {SYS_getpid, "getpid"},
+#endif
+#ifdef SYS_sendfile
+    {SYS_sendfile, "sendfile"},
+#endif
+#ifdef SYS_socket
+    {SYS_socket, "socket"},
+#endif
+#ifdef SYS_connect
+    {SYS_connect, "connect"},
+#endif
+#ifdef SYS_accept
+    {SYS_accept, "accept"},
+#endif
+#ifdef SYS_sendto
+    {SYS_sendto, "sendto"},
+#endif
+#ifdef SYS_recvfrom
+    {SYS_recvfrom, "recvfrom"},
+#endif
+#ifdef SYS_sendmsg
+    {SYS_sendmsg, "sendmsg"},
+#endif
+#ifdef SYS_recvmsg
+    {SYS_recvmsg, "recvmsg"},
+#endif
+#ifdef SYS_shutdown
+    {SYS_shutdown, "shutdown"},
+#endif
+#ifdef SYS_bind
+    {SYS_bind, "bind"},
+#endif
+#ifdef SYS_listen
+    {SYS_listen, "listen"},
+#endif
+#ifdef SYS_getsockname
+    {SYS_getsockname, "getsockname"},
+#endif
+#ifdef SYS_getpeername
+    {SYS_getpeername, "getpeername"},
+#endif
+#ifdef SYS_socketpair
+    {SYS_socketpair, "socketpair"},
+#endif
+#ifdef SYS_setsockopt
+    {SYS_setsockopt, "setsockopt"},
+#endif
+#ifdef SYS_getsockopt
+    {SYS_getsockopt, "getsockopt"},
+#endif
+#ifdef SYS_clone
+    {SYS_clone, "clone"},
+#endif
+#ifdef SYS_fork
+    {SYS_fork, "fork"},
+#endif
+#ifdef SYS_vfork
+    {SYS_vfork, "vfork"},
+#endif
+#ifdef SYS_execve
+    {SYS_execve, "execve"},
+#endif
+#ifdef SYS_exit
+    {SYS_exit, "exit"},
+#endif
+#ifdef SYS_wait4
+    {SYS_wait4, "wait4"},
+#endif
+#ifdef SYS_kill
+    {SYS_kill, "kill"},
+#endif
+#ifdef SYS_uname
+    {SYS_uname, "uname"},
+#endif
+#ifdef SYS_fcntl
+    {SYS_fcntl, "fcntl"},
+#endif
+#ifdef SYS_flock
+    {SYS_flock, "flock"},
+#endif
+#ifdef SYS_fsync
+    {SYS_fsync, "fsync"},
+#endif
+#ifdef SYS_fdatasync
+    {SYS_fdatasync, "fdatasync"},
+#endif
+#ifdef SYS_truncate
+    {SYS_truncate, "truncate"},
+#endif
+#ifdef SYS_ftruncate
+    {SYS_ftruncate, "ftruncate"},
+#endif
+#ifdef SYS_getdents
+    {SYS_getdents, "getdents"},
+#endif
+#ifdef SYS_getcwd
+    {SYS_getcwd, "getcwd"},
+#endif
+#ifdef SYS_chdir
+    {SYS_chdir, "chdir"},
+#endif
+#ifdef SYS_fchdir
+    {SYS_fchdir, "fchdir"},
+#endif
+#ifdef SYS_rename
+    {SYS_rename, "rename"},
+#endif
+#ifdef SYS_mkdir
+    {SYS_mkdir, "mkdir"},
+#endif
+#ifdef SYS_rmdir
+    {SYS_rmdir, "rmdir"},
+#endif
+#ifdef SYS_creat
+    {SYS_creat, "creat"},
+#endif
+#ifdef SYS_link
+    {SYS_link, "link"},
+#endif
+#ifdef SYS_unlink
+    {SYS_unlink, "unlink"},
+#endif
+#ifdef SYS_symlink
+    {SYS_symlink, "symlink"},
+#endif
+#ifdef SYS_readlink
+    {SYS_readlink, "readlink"},
+#endif
+#ifdef SYS_chmod
+    {SYS_chmod, "chmod"},
+#endif
+#ifdef SYS_fchmod
+    {SYS_fchmod, "fchmod"},
+#endif
+#ifdef SYS_chown
+    {SYS_chown, "chown"},
+#endif
+#ifdef SYS_umask
+    {SYS_umask, "umask"},
+#endif
+#ifdef SYS_gettimeofday
+    {SYS_gettimeofday, "gettimeofday"},
+#endif
+#ifdef SYS_getrlimit
+    {SYS_getrlimit, "getrlimit"},
+#endif
+#ifdef SYS_getrusage
+    {SYS_getrusage, "getrusage"},
+#endif
+#ifdef SYS_sysinfo
+    {SYS_sysinfo, "sysinfo"},
+#endif
+#ifdef SYS_times
+    {SYS_times, "times"},
+#endif
+#ifdef SYS_getuid
+    {SYS_getuid, "getuid"},
+#endif
+#ifdef SYS_getgid
+    {SYS_getgid, "getgid"},
+#endif
+#ifdef SYS_geteuid
+    {SYS_geteuid, "geteuid"},
+#endif
+#ifdef SYS_getegid
+    {SYS_getegid, "getegid"},
+#endif
+#ifdef SYS_getppid
+    {SYS_getppid, "getppid"},
+#endif
+#ifdef SYS_getpgrp
+    {SYS_getpgrp, "getpgrp"},
+#endif
+#ifdef SYS_setsid
+    {SYS_setsid, "setsid"},
+#endif
+#ifdef SYS_sigaltstack
+    {SYS_sigaltstack, "sigaltstack"},
+#endif
+#ifdef SYS_statfs
+    {SYS_statfs, "statfs"},
+#endif
+#ifdef SYS_fstatfs
+    {SYS_fstatfs, "fstatfs"},
+#endif
+#ifdef SYS_mlock
+    {SYS_mlock, "mlock"},
+#endif
+#ifdef SYS_munlock
+    {SYS_munlock, "munlock"},
+#endif
+#ifdef SYS_prctl
+    {SYS_prctl, "prctl"},
+#endif
+#ifdef SYS_arch_prctl
+    {SYS_arch_prctl, "arch_prctl"},
+#endif
+#ifdef SYS_gettid
+    {SYS_gettid, "gettid"},
+#endif
+#ifdef SYS_futex
+    {SYS_futex, "futex"},
+#endif
+#ifdef SYS_sched_setaffinity
+    {SYS_sched_setaffinity, "sched_setaffinity"},
+#endif
+#ifdef SYS_sched_getaffinity
+    {SYS_sched_getaffinity, "sched_getaffinity"},
+#endif
+#ifdef SYS_set_tid_address
+    {SYS_set_tid_address, "set_tid_address"},
+#endif
+#ifdef SYS_getdents64
+    {SYS_getdents64, "getdents64"},
+#endif
+#ifdef SYS_clock_gettime
+    {SYS_clock_gettime, "clock_gettime"},
+#endif
+#ifdef SYS_clock_nanosleep
+    {SYS_clock_nanosleep, "clock_nanosleep"},
+#endif
+#ifdef SYS_exit_group
+    {SYS_exit_group, "exit_group"},
+#endif
+#ifdef SYS_epoll_wait
+    {SYS_epoll_wait, "epoll_wait"},
+#endif
+#ifdef SYS_epoll_ctl
+    {SYS_epoll_ctl, "epoll_ctl"},
+#endif
+#ifdef SYS_tgkill
+    {SYS_tgkill, "tgkill"},
+#endif
+#ifdef SYS_waitid
+    {SYS_waitid, "waitid"},
+#endif
+#ifdef SYS_openat
+    {SYS_openat, "openat"},
+#endif
+#ifdef SYS_mkdirat
+    {SYS_mkdirat, "mkdirat"},
+#endif
+#ifdef SYS_newfstatat
+    {SYS_newfstatat, "newfstatat"},
+#endif
+#ifdef SYS_unlinkat
+    {SYS_unlinkat, "unlinkat"},
+#endif
+#ifdef SYS_renameat
+    {SYS_renameat, "renameat"},
+#endif
+#ifdef SYS_readlinkat
+    {SYS_readlinkat, "readlinkat"},
+#endif
+#ifdef SYS_faccessat
+    {SYS_faccessat, "faccessat"},
+#endif
+#ifdef SYS_pselect6
+    {SYS_pselect6, "pselect6"},
+#endif
+#ifdef SYS_ppoll
+    {SYS_ppoll, "ppoll"},
+#endif
+#ifdef SYS_set_robust_list
+    {SYS_set_robust_list, "set_robust_list"},
+#endif
+#ifdef SYS_get_robust_list
+    {SYS_get_robust_list, "get_robust_list"},
+#endif
+#ifdef SYS_splice
+    {SYS_splice, "splice"},
+#endif
+#ifdef SYS_tee
+    {SYS_tee, "tee"},
+#endif
+#ifdef SYS_sync_file_range
+    {SYS_sync_file_range, "sync_file_range"},
+#endif
+#ifdef SYS_vmsplice
+    {SYS_vmsplice, "vmsplice"},
+#endif
+#ifdef SYS_epoll_pwait
+    {SYS_epoll_pwait, "epoll_pwait"},
+#endif
+#ifdef SYS_eventfd
+    {SYS_eventfd, "eventfd"},
+#endif
+#ifdef SYS_timerfd_create
+    {SYS_timerfd_create, "timerfd_create"},
+#endif
+#ifdef SYS_timerfd_settime
+    {SYS_timerfd_settime, "timerfd_settime"},
+#endif
+#ifdef SYS_fallocate
+    {SYS_fallocate, "fallocate"},
+#endif
+#ifdef SYS_accept4
+    {SYS_accept4, "accept4"},
+#endif
+#ifdef SYS_eventfd2
+    {SYS_eventfd2, "eventfd2"},
+#endif
+#ifdef SYS_epoll_create1
+    {SYS_epoll_create1, "epoll_create1"},
+#endif
+#ifdef SYS_dup3
+    {SYS_dup3, "dup3"},
+#endif
+#ifdef SYS_pipe2
+    {SYS_pipe2, "pipe2"},
+#endif
+#ifdef SYS_preadv
+    {SYS_preadv, "preadv"},
+#endif
+#ifdef SYS_pwritev
+    {SYS_pwritev, "pwritev"},
+#endif
+#ifdef SYS_prlimit64
+    {SYS_prlimit64, "prlimit64"},
+#endif
+#ifdef SYS_recvmmsg
+    {SYS_recvmmsg, "recvmmsg"},
+#endif
+#ifdef SYS_sendmmsg
+    {SYS_sendmmsg, "sendmmsg"},
+#endif
+#ifdef SYS_getrandom
+    {SYS_getrandom, "getrandom"},
+#endif
+#ifdef SYS_memfd_create
+    {SYS_memfd_create, "memfd_create"},
+#endif
+#ifdef SYS_membarrier
+    {SYS_membarrier, "membarrier"},
+#endif
+#ifdef SYS_copy_file_range
+    {SYS_copy_file_range, "copy_file_range"},
+#endif
+#ifdef SYS_statx
+    {SYS_statx, "statx"},
+#endif
+#ifdef SYS_rseq
+    {SYS_rseq, "rseq"},
+#endif
+#ifdef SYS_io_uring_setup
+    {SYS_io_uring_setup, "io_uring_setup"},
+#endif
+#ifdef SYS_io_uring_enter
+    {SYS_io_uring_enter, "io_uring_enter"},
+#endif
+#ifdef SYS_clone3
+    {SYS_clone3, "clone3"},
+#endif
+#ifdef SYS_close_range
+    {SYS_close_range, "close_range"},
+#endif
+#ifdef SYS_openat2
+    {SYS_openat2, "openat2"},
+#endif
+#ifdef SYS_faccessat2
+    {SYS_faccessat2, "faccessat2"},
+#endif
+#ifdef SYS_epoll_pwait2
+    {SYS_epoll_pwait2, "epoll_pwait2"},
+#endif
+};
+
+// private
+static string syscallName(uint64_t nr) {
+    if (nr & COMPAT) return "compat_" + std::to_string(nr & ~COMPAT);
+    auto it = NAMES.find(nr);
+    return it != NAMES.end() ? it->second : "syscall_" + std::to_string(nr);
+}
+
+// private: таймер нужен только чтобы прерывать блокирующий waitid
+static void onTick(int) {}
+
+// private: SIGEV_THREAD_ID — сигнал получает именно поток трассировщика, а не сэмплер монитора
+static bool armTicker() {
+    struct sigaction action {};
+    action.sa_handler = onTick;  // без SA_RESTART: waitid должен вернуть EINTR
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGRTMIN + 1, &action, &previousAction) != 0) return false;
+
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGRTMIN + 1;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    if (timer_create(CLOCK_MONOTONIC, &event, &ticker) != 0) {
+        sigaction(SIGRTMIN + 1, &previousAction, nullptr);
+        return false;
+    }
+    itimerspec spec{};
+    spec.it_interval.tv_nsec = spec.it_value.tv_nsec = TICK_MS * 1000000L;
+    timer_settime(ticker, 0, &spec, nullptr);
+    return tickerArmed = true;
+}
+
+// private
+static void disarmTicker() {
+    if (!tickerArmed) return;
+    timer_delete(ticker);
+    sigaction(SIGRTMIN + 1, &previousAction, nullptr);
+    tickerArmed = false;
+}
+
+// private: переключает окна; при включении останавливает потоки, чтобы продолжить их с PTRACE_SYSCALL
+static void updateWindow() {
+    if (percent >= 100) return;
+    auto now = std::chrono::steady_clock::now();
+    auto phase = std::chrono::duration_cast<std::chrono::milliseconds>(now - started).count() % WINDOW_MS;
+    bool on = phase < static_cast<long long>(WINDOW_MS * percent / 100);
+    if (on == tracing) return;
+
+    tracing = on;
+    if (on) {
+        windowStart = now;
+        for (pid_t tid : tracees)
+            if (interrupted.insert(tid).second) ptrace(PTRACE_INTERRUPT, tid, nullptr, nullptr);
+    }
+    else traced += now - windowStart;
+}
+
+// private: вне окна поток идёт без остановок на системных вызовах
+static void resume(pid_t tid, int sig = 0) {
+    ptrace(tracing ? PTRACE_SYSCALL : PTRACE_CONT, tid, nullptr, reinterpret_cast<void*>(static_cast<long>(sig)));
+}
+
+// private
+static void handleSyscall(pid_t tid) {
+    SyscallInfo info{};
+    if (ptrace(PTRACE_GET_SYSCALL_INFO, tid, reinterpret_cast<void*>(sizeof(info)), &info) <= 0) {
+        // ядро до 5.3: без вызова не отличить вход от выхода, пустая таблица выглядела бы как "вызовов нет"
+        if (!infoMissing)
+            logMessage(WARN, "PTRACE_GET_SYSCALL_INFO недоступен (нужно ядро 5.3+): таблицы системных вызовов не будет",
+                       true);
+        infoMissing = true;
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (info.op == 1) {
+        uint64_t nr = NATIVE_ARCH && info.arch != NATIVE_ARCH ? info.entry.nr | COMPAT : info.entry.nr;
+        if (tracing) inFlight[tid] = {nr, now};
+        return;
+    }
+    if (info.op != 2) return;
+
+    // выход без входа — вызов начался до подключения или вне окна
+    auto it = inFlight.find(tid);
+    if (it == inFlight.end()) return;
+    SyscallStat& s = stats[it->second.nr];
+    auto ns = static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - it->second.start).count());
+    ++s.calls;
+    if (info.exit.isError) ++s.errors;
+    s.totalNs += ns;
+    s.maxNs = std::max(s.maxNs, ns);
+    inFlight.erase(it);
+}
+
+// private
+static void handleStop(pid_t tid, int status) {
+    if (WIFEXITED(status) || WIFSIGNALED(status)) {
+        tracees.erase(tid);
+        interrupted.erase(tid);
+        inFlight.erase(tid);
+        return;
+    }
+    if (!WIFSTOPPED(status)) return;
+
+    int sig = WSTOPSIG(status);
+    int event = status >> 16;
+    if (sig == (SIGTRAP | 0x80)) {
+        handleSyscall(tid);
+        resume(tid);
+    }
+    else if (event == PTRACE_EVENT_STOP) {
+        tracees.insert(tid);
+        interrupted.erase(tid);
+        // сигнал остановки ядро сообщает только при group-stop (Ctrl-Z, kill -STOP): продолжать нельзя,
+        // программа должна стоять до SIGCONT; после него придёт новая остановка с SIGTRAP.
+        // Так же и для нашего PTRACE_INTERRUPT, попавшего на уже остановленную программу
+        if (sig == SIGSTOP || sig == SIGTSTP || sig == SIGTTIN || sig == SIGTTOU)
+            ptrace(PTRACE_LISTEN, tid, nullptr, nullptr);
+        // наш PTRACE_INTERRUPT или первая остановка нового потока/процесса
+        else resume(tid);
+    }
+    else if (event != 0) {
+        unsigned long child = 0;
+        if (event == PTRACE_EVENT_CLONE || event == PTRACE_EVENT_FORK || event == PTRACE_EVENT_VFORK) {
+            ptrace(PTRACE_GETEVENTMSG, tid, nullptr, &child);
+            if (child) tracees.insert(static_cast<pid_t>(child));
+        }
+        // execve не возвращается в старый образ, его выход придёт уже из нового
+        resume(tid);
+    }
+    else resume(tid, sig);  // обычный сигнал — передаём программе как есть
+}
+
+bool startSyscallTrace(pid_t pid, unsigned samplePercent) {
+    tracees.clear();
+    interrupted.clear();
+    inFlight.clear();
+    stats.clear();
+    infoMissing = false;
+    traced = {};
+    percent = std::min(std::max(samplePercent, 1u), 100u);
+    tracing = true;
+
+    long options = PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK |
+                   PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL;
+    if (ptrace(PTRACE_SEIZE, pid, nullptr, reinterpret_cast<void*>(options)) != 0) {
+        logMessage(FAULT, "Трассировка системных вызовов недоступна: ptrace запрещён");
+        return false;
+    }
+    // после SEIZE процесс идёт без остановок на вызовах — останавливаем и продолжаем через PTRACE_SYSCALL
+    tracees = {pid};
+    interrupted = {pid};
+    ptrace(PTRACE_INTERRUPT, pid, nullptr, nullptr);
+
+    if (percent < 100 && !armTicker()) {
+        logMessage(WARN, "Не удалось завести таймер окон, системные вызовы трассируются постоянно", true);
+        percent = 100;
+    }
+    started = windowStart = std::chrono::steady_clock::now();
+    logMessage(WARN, "Трассировка системных вызовов через ptrace: программа работает заметно медленнее" +
+                         (percent < 100 ? " (только " + std::to_string(percent) + "% времени)" : string()), true);
+    return true;
+}
+
+void waitSyscallTraced(pid_t pid) {
+    while (true) {
+        // заглядываем без освобождения: корневой зомби нужен монитору и reapProcess
+        siginfo_t info{};
+        if (waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOWAIT | __WALL) != 0) {
+            if (errno == EINTR) {
+                updateWindow();
+                continue;
+            }
+            break;
+        }
+        if (info.si_pid == pid &&
+            (info.si_code == CLD_EXITED || info.si_code == CLD_KILLED || info.si_code == CLD_DUMPED))
+            break;
+        int status = 0;
+        if (waitpid(info.si_pid, &status, __WALL) == info.si_pid) handleStop(info.si_pid, status);
+        updateWindow();
+    }
+    disarmTicker();
+    if (tracing) traced += std::chrono::steady_clock::now() - windowStart;
+
+    // отпускаем потомков, переживших корневой процесс
+    tracees.erase(pid);
+    for (pid_t tid : tracees) {
+        if (!interrupted.count(tid)) ptrace(PTRACE_INTERRUPT, tid, nullptr, nullptr);
+        int status = 0;
+        if (waitpid(tid, &status, __WALL) == tid && WIFSTOPPED(status)) ptrace(PTRACE_DETACH, tid, nullptr, nullptr);
+    }
+    tracees.clear();
+    interrupted.clear();
+}
+
+void finishSyscallTrace(SyscallResult& result) {
+    result.percent = percent;
+    result.tracedMs = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::milliseconds>(traced).count());
+    for (auto& s : stats) {
+        s.second.name = syscallName(s.first);
+        result.calls.push_back(s.second);
+    }
+    std::sort(result.calls.begin(), result.calls.end(),
+              [](const SyscallStat& a, const SyscallStat& b) { return a.totalNs > b.totalNs; });
+    result.ok = !infoMissing || !result.calls.empty();
+    stats.clear();
+}
+#endif
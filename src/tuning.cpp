@@ -0,0 +1,201 @@
+#include "../tuning.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "../args.hpp"
+#include "../logger.hpp"
+#include "../runner.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+std::vector<int> parseCpuList(const string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    string part;
+    while (std::getline(ss, part, ',')) {
+        part.erase(std::remove_if(part.begin(), part.end(), [](unsigned char c) { return isspace(c); }), part.end());
+        if (part.empty()) continue;
+        if (!isdigit(static_cast<unsigned char>(part[0]))) return {};
+        size_t dash = part.find('-');
+        int first = atoi(part.c_str());
+        int last = dash == string::npos ? first : atoi(part.c_str() + dash + 1);
+        if (last < first || last >= 1024) return {};
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+// private: CPU, на которых crun разрешено работать
+static std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#ifdef _WIN32
+    DWORD_PTR process = 0, system = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system))
+        for (int i = 0; i < static_cast<int>(sizeof(DWORD_PTR) * 8); ++i)
+            if (process & (DWORD_PTR(1) << i)) cpus.push_back(i);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        for (int i = 0; i < CPU_SETSIZE; ++i)
+            if (CPU_ISSET(i, &set)) cpus.push_back(i);
+#endif
+    return cpus;
+}
+
+std::vector<int> runCpus() {
+    if (!arguments.cpus.empty()) {
+        std::vector<int> cpus = parseCpuList(arguments.cpus);
+        if (!cpus.empty()) return cpus;
+    }
+    return allowedCpus();
+}
+
+// private: "0-3,6" для вывода
+static string formatCpuList(const std::vector<int>& cpus) {
+    string text;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!text.empty()) text += ",";
+        text += std::to_string(cpus[i]);
+        if (j > i) text += "-" + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return text;
+}
+
+#ifndef _WIN32
+// private: "be:4", "rt", "idle" → IOPRIO_PRIO_VALUE(класс, уровень); -1 — не распознано
+static int parseIoPriority(const string& text) {
+    size_t colon = text.find(':');
+    string name = text.substr(0, colon);
+    int level = colon == string::npos ? 4 : atoi(text.c_str() + colon + 1);
+    int cls = name == "rt" ? 1 : name == "be" ? 2 : name == "idle" ? 3 : 0;
+    if (!cls || level < 0 || level > 7) return -1;
+    if (cls == 3) level = 0;
+    return cls << 13 | level;
+}
+
+// private: занятость CPU по /proc/stat за interval, доля 0..1 для каждого из cpus
+static std::vector<double> sampleCpuBusy(const std::vector<int>& cpus, std::chrono::milliseconds interval) {
+    auto read = [&]() {
+        std::vector<std::pair<unsigned long long, unsigned long long>> times(cpus.size());  // занято, всего
+        std::ifstream stat("/proc/stat");
+        string line;
+        while (std::getline(stat, line)) {
+            if (line.compare(0, 3, "cpu") != 0 || !isdigit(static_cast<unsigned char>(line[3]))) continue;
+            std::istringstream ss(line.substr(3));
+            int cpu;
+            unsigned long long v[8] = {};
+            ss >> cpu;
+            for (auto& x : v) ss >> x;
+            auto it = std::find(cpus.begin(), cpus.end(), cpu);
+            if (it == cpus.end()) continue;
+            unsigned long long total = 0;
+            for (auto x : v) total += x;
+            // idle и iowait не считаются занятостью
+            times[it - cpus.begin()] = {total - v[3] - v[4], total};
+        }
+        return times;
+    };
+    auto before = read();
+    std::this_thread::sleep_for(interval);
+    auto after = read();
+    std::vector<double> busy(cpus.size());
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        unsigned long long total = after[i].second - before[i].second;
+        busy[i] = total ? static_cast<double>(after[i].first - before[i].first) / total : 0;
+    }
+    return busy;
+}
+
+void applyRunControls(ChildSetup& setup) {
+    if (!setup.pinned && !arguments.cpus.empty()) {
+        std::vector<int> cpus = parseCpuList(arguments.cpus);
+        for (int cpu : cpus) CPU_SET(cpu, &setup.cpus);
+        setup.pinned = !cpus.empty();
+    }
+    setup.nice = arguments.nice;
+    if (!arguments.ioPriority.empty()) setup.ioPriority = parseIoPriority(arguments.ioPriority);
+    setup.noAslr = arguments.noAslr;
+    setup.cpuSeconds = arguments.cpuLimit;
+    // без cgroup лимит памяти можно выразить только через адресное пространство
+    setup.addressSpace = (arguments.addressLimitMb ? arguments.addressLimitMb : arguments.memoryLimitMb) * 1024 * 1024;
+    setup.openFiles = arguments.filesLimit;
+}
+#endif
+
+void checkRunNoise() {
+    if (!arguments.cpus.empty() && parseCpuList(arguments.cpus).empty())
+        logMessage(WARN, "Неверный список CPU: " + arguments.cpus + " (нужно, например, 0,2-3)");
+#ifdef _WIN32
+    if (arguments.nice || !arguments.ioPriority.empty() || arguments.noAslr)
+        logMessage(WARN, "-nice, -ioprio и -no-aslr доступны только в Linux");
+#else
+    if (!arguments.ioPriority.empty() && parseIoPriority(arguments.ioPriority) < 0)
+        logMessage(WARN, "Неверный -ioprio: " + arguments.ioPriority + " (нужно rt|be|idle[:0-7])");
+    if (arguments.nice < 0 && geteuid() != 0)
+        logMessage(WARN, "Отрицательный nice без прав root не применится");
+
+    std::vector<int> cpus = runCpus();
+    if (!arguments.cpus.empty() || arguments.nice || !arguments.ioPriority.empty() || arguments.noAslr) {
+        string applied = "CPU " + formatCpuList(cpus);
+        if (arguments.nice) applied += ", nice " + std::to_string(arguments.nice);
+        if (!arguments.ioPriority.empty()) applied += ", ioprio " + arguments.ioPriority;
+        if (arguments.noAslr) applied += ", без ASLR";
+        logMessage(INFO, "Условия запуска: " + applied, false, "🎛️");
+    }
+
+    // частота плавает, если governor не performance
+    std::vector<int> slow;
+    string governor;
+    for (int cpu : cpus) {
+        std::ifstream f("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+        string value;
+        if (!(f >> value) || value == "performance") continue;
+        slow.push_back(cpu);
+        governor = value;
+    }
+    if (!slow.empty())
+        logMessage(WARN, "Governor " + governor + " на CPU " + formatCpuList(slow) +
+                             ": частота меняется во время замера, лучше performance", true);
+
+    // SMT-соседи делят с программой ядро: их нагрузка замедляет её непредсказуемо
+    if (arguments.cpus.empty()) return;
+    std::vector<int> siblings;
+    for (int cpu : cpus) {
+        std::ifstream f("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+        string list;
+        if (!(f >> list)) continue;
+        for (int sibling : parseCpuList(list))
+            if (!std::binary_search(cpus.begin(), cpus.end(), sibling)) siblings.push_back(sibling);
+    }
+    std::sort(siblings.begin(), siblings.end());
+    siblings.erase(std::unique(siblings.begin(), siblings.end()), siblings.end());
+    if (siblings.empty()) return;
+
+    std::vector<double> busy = sampleCpuBusy(siblings, std::chrono::milliseconds(200));
+    std::vector<int> loaded;
+    for (size_t i = 0; i < siblings.size(); ++i)
+        if (busy[i] > 0.1) loaded.push_back(siblings[i]);
+    if (!loaded.empty())
+        logMessage(WARN, "SMT-соседи выбранных CPU заняты (" + formatCpuList(loaded) +
+                             "): добавьте их в -cpus или освободите", true);
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Описательная статистика серии замеров
+struct Summary {
+    size_t n = 0;
+    double mean = 0;
+    double median = 0;
+    double stddev = 0;  // выборочное (n - 1)
+    double min = 0;
+    double max = 0;
+    double q1 = 0, q3 = 0;
+    double p90 = 0, p99 = 0;      // хвост распределения (задержки)
+    unsigned outliers = 0;        // за 1.5 IQR от квартилей (по Тьюки)
+    unsigned severeOutliers = 0;  // за 3 IQR
+};
+
+Summary summarize(std::vector<double> values);
+
+struct Interval {
+    double low = 0, high = 0;
+};
+
+// Двусторонний p-value U-критерия Манна–Уитни (нормальное приближение с поправкой на связи)
+double mannWhitneyP(const std::vector<double>& a, const std::vector<double>& b, double* u = nullptr);
+// Доверительный интервал отношения mean(b) / mean(a) бутстрепом; level — например 0.95
+Interval bootstrapRatio(const std::vector<double>& a, const std::vector<double>& b, double level);
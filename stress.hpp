@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+// crun stress: генератор (seed и аргументы из -- в argv) → эталон и решение на его выводе,
+// сравнение по arguments.compare на всех CPU до первого расхождения или arguments.stressLimit
+// итераций (или по вердикту checker, если он задан). Вход, ответ эталона и вывод решения
+// с расхождением сохраняются в папку сборки
+int runStress(const std::string& generator, const std::string& reference, const std::string& solution,
+              const std::string& checker = "");
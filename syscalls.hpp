@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct SyscallStat {
+    std::string name;
+    unsigned long long calls = 0;
+    unsigned long long errors = 0;   // вернул -errno
+    unsigned long long totalNs = 0;  // от входа до выхода, вместе с накладными расходами ptrace
+    unsigned long long maxNs = 0;
+};
+
+struct SyscallResult {
+    std::vector<SyscallStat> calls;  // по убыванию суммарного времени
+    unsigned percent = 100;          // доля времени, когда шла трассировка
+    unsigned long long tracedMs = 0; // сколько времени трассировка была включена
+    bool ok = false;
+};
+
+#ifndef _WIN32
+#include <sys/types.h>
+
+// Подключается через ptrace к процессу, ждущему exec; percent < 100 — трассировать окнами,
+// percent% каждой секунды, остальное время программа работает без остановок
+bool startSyscallTrace(pid_t pid, unsigned percent);
+// Ждёт завершения pid, не освобождая зомби, и собирает статистику вызовов всего дерева
+void waitSyscallTraced(pid_t pid);
+void finishSyscallTrace(SyscallResult& result);
+#endif
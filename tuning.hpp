@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Номера CPU из списка вида "0,2-3"; пустой вектор — список пуст или неверен
+std::vector<int> parseCpuList(const std::string& list);
+// CPU, на которых будет работать программа: из -cpus или все, доступные crun
+std::vector<int> runCpus();
+// Предупреждает об источниках шума в замерах: governor не performance, занятые SMT-соседи
+void checkRunNoise();
+
+#ifndef _WIN32
+struct ChildSetup;
+
+// Переносит -cpus (если affinity ещё не задана), -nice, -ioprio, -no-aslr и rlimit-лимиты
+// из arguments в setup
+void applyRunControls(ChildSetup& setup);
+#endif